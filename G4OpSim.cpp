@@ -6,36 +6,283 @@
 
 #include "PhysicsList.h"
 #include "DetectorConstruction.h"
-#include "PrimaryGeneration.h"
-#include "RunAction.h"
-#include "EventAction.h"
-#include "TrackingAction.h"
-#include "SteppingAction.h"
+#include "ActionInitialization.h"
+#include "RunSummary.h"
+#include "SimulationServer.h"
 
-#include <G4RunManager.hh>
+#include <G4RunManagerFactory.hh>
 #include <G4UImanager.hh>
+#include <G4OpticalParameters.hh>
+#ifdef G4OPSIM_WITH_UIVIS
 #include <G4VisExecutive.hh>
 #include <G4UIterminal.hh>
 #include <G4UItcsh.hh>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <chrono>
+#include <string>
+#include <fstream>
+
+
+void PrintUsage(const char* program)
+{
+  G4cerr << "Usage: " << program << " [options] [macro]\n"
+         << "Batch mode (a macro and/or a number of events given):\n"
+         << "  -n, --events <n>         events to run after the macro (if any)\n"
+         << "  -s, --seed <seed>        seed of the random engine (and of the\n"
+         << "                           counter-based streams)\n"
+         << "  -o, --output <file>      hits file: ROOT if named *.root, flat\n"
+         << "                           columnar otherwise\n"
+         << "  -P, --profile <period>   time 1 in <period> steps (step profiler)\n"
+         << "  -i, --invoke-sd <bool>   optical boundary invokes the sensitive\n"
+         << "                           detectors (default: true)\n"
+         << "Server mode:\n"
+         << "  -S, --server <socket>    initialize once and run the jobs received\n"
+         << "                           on a UNIX socket ('-': standard input)\n"
+         << "Initialization:\n"
+         << "  -t, --threads <n>        number of worker threads\n"
+         << "  -r, --run-manager <type> serial, mt or tasking (default: "
+         << "Geant4 build default)\n"
+         << "  -p, --physics <mode>     full (default) or optical (optical-photon\n"
+         << "                           transport only)\n"
+         << "  -u, --uniform-properties <tolerance>\n"
+         << "                           look up absorption lengths on uniform\n"
+         << "                           grids resampled within the given relative\n"
+         << "                           error (e.g. 1e-3; default: exact tables)"
+         << G4endl;
+}
+
+
+// Number taking up the whole argument
+G4bool ParseLong(const char* arg, long& value)
+{
+  char* end = nullptr;
+  errno = 0;
+  value = std::strtol(arg, &end, 10);
+  return *arg != '\0' && *end == '\0' && errno == 0;
+}
+
+G4bool ParsePositive(const char* arg, G4int& value)
+{
+  long v;
+  if (!ParseLong(arg, v) || v <= 0 || v > INT_MAX) return false;
+  value = static_cast<G4int>(v);
+  return true;
+}
+
+G4bool ParseDouble(const char* arg, G4double& value)
+{
+  char* end = nullptr;
+  errno = 0;
+  value = std::strtod(arg, &end);
+  return *arg != '\0' && *end == '\0' && errno == 0;
+}
+
+// Run a macro file. Returns false (with a message) if it cannot be found
+// or any of its commands fails, which aborts the rest of the macro.
+G4bool ExecuteMacro(G4UImanager* UI, const G4String& macro)
+{
+  const G4String path = UI->FindMacroPath(macro);
+  if (!std::ifstream(path)) {
+    G4cerr << "Cannot open macro file " << macro << "." << G4endl;
+    return false;
+  }
+  const G4int status = UI->ApplyCommand("/control/execute " + path);
+  if (status != fCommandSucceeded) {
+    G4cerr << "Macro " << macro << " failed (status " << status << ")." << G4endl;
+    return false;
+  }
+  return true;
+}
 
 
 int main(int argc, char const *argv[])
 {
-  // Construct the run manager and set the initialization classes next
-  G4RunManager* runmgr = new G4RunManager();
-  runmgr->SetUserInitialization(new PhysicsList());
+  // Parse the command line. The only argument that is not an option is
+  // taken as the name of a macro file; if neither a macro nor a number of
+  // events is given, an interactive session is started. Unknown options,
+  // extra arguments and malformed numbers are errors.
+  G4int num_threads = 0;
+  G4RunManagerType runmgr_type = G4RunManagerType::Default;
+  G4String physics_mode = "full";
+  G4bool uniform_lookups = false;
+  G4double uniform_tolerance = 1.e-3;
+  G4String macro;
+  G4int num_events = 0;
+  G4int seed = 0;
+  G4String output;
+  G4int profile_period = 0;
+  G4bool invoke_sd = true;
+  G4String server_socket;
+
+  for (G4int i=1; i<argc; ++i) {
+    if (!std::strcmp(argv[i], "-t") || !std::strcmp(argv[i], "--threads")) {
+      if (++i == argc) { PrintUsage(argv[0]); return EXIT_FAILURE; }
+      if (!ParsePositive(argv[i], num_threads)) {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (!std::strcmp(argv[i], "-r") || !std::strcmp(argv[i], "--run-manager")) {
+      if (++i == argc) { PrintUsage(argv[0]); return EXIT_FAILURE; }
+      if      (!std::strcmp(argv[i], "serial"))  runmgr_type = G4RunManagerType::Serial;
+      else if (!std::strcmp(argv[i], "mt"))      runmgr_type = G4RunManagerType::MT;
+      else if (!std::strcmp(argv[i], "tasking")) runmgr_type = G4RunManagerType::Tasking;
+      else { PrintUsage(argv[0]); return EXIT_FAILURE; }
+    }
+    else if (!std::strcmp(argv[i], "-p") || !std::strcmp(argv[i], "--physics")) {
+      if (++i == argc) { PrintUsage(argv[0]); return EXIT_FAILURE; }
+      physics_mode = argv[i];
+      if (physics_mode != "full" && physics_mode != "optical") {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (!std::strcmp(argv[i], "-u") || !std::strcmp(argv[i], "--uniform-properties")) {
+      if (++i == argc) { PrintUsage(argv[0]); return EXIT_FAILURE; }
+      uniform_lookups = true;
+      if (!ParseDouble(argv[i], uniform_tolerance) || uniform_tolerance <= 0.) {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (!std::strcmp(argv[i], "-n") || !std::strcmp(argv[i], "--events")) {
+      if (++i == argc) { PrintUsage(argv[0]); return EXIT_FAILURE; }
+      if (!ParsePositive(argv[i], num_events)) {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (!std::strcmp(argv[i], "-s") || !std::strcmp(argv[i], "--seed")) {
+      if (++i == argc) { PrintUsage(argv[0]); return EXIT_FAILURE; }
+      if (!ParsePositive(argv[i], seed)) {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (!std::strcmp(argv[i], "-o") || !std::strcmp(argv[i], "--output")) {
+      if (++i == argc) { PrintUsage(argv[0]); return EXIT_FAILURE; }
+      output = argv[i];
+    }
+    else if (!std::strcmp(argv[i], "-P") || !std::strcmp(argv[i], "--profile")) {
+      if (++i == argc) { PrintUsage(argv[0]); return EXIT_FAILURE; }
+      if (!ParsePositive(argv[i], profile_period)) {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (!std::strcmp(argv[i], "-i") || !std::strcmp(argv[i], "--invoke-sd")) {
+      if (++i == argc) { PrintUsage(argv[0]); return EXIT_FAILURE; }
+      if      (!std::strcmp(argv[i], "true"))  invoke_sd = true;
+      else if (!std::strcmp(argv[i], "false")) invoke_sd = false;
+      else { PrintUsage(argv[0]); return EXIT_FAILURE; }
+    }
+    else if (!std::strcmp(argv[i], "-S") || !std::strcmp(argv[i], "--server")) {
+      if (++i == argc) { PrintUsage(argv[0]); return EXIT_FAILURE; }
+      server_socket = argv[i];
+    }
+    else if (!std::strcmp(argv[i], "-h") || !std::strcmp(argv[i], "--help")) {
+      PrintUsage(argv[0]);
+      return EXIT_SUCCESS;
+    }
+    else if (argv[i][0] == '-' || !macro.empty()) {
+      G4cerr << "Unexpected argument '" << argv[i] << "'." << G4endl;
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    else {
+      macro = argv[i];
+    }
+  }
+
+  const G4bool server = !server_socket.empty();
+  const G4bool batch = !server && (!macro.empty() || num_events > 0);
+
+#ifndef G4OPSIM_WITH_UIVIS
+  if (!batch && !server) {
+    G4cerr << "Built without UI/vis drivers: give a macro or a number "
+           << "of events." << G4endl;
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+#endif
+
+  // In stdin mode, the server takes over the standard output
+  // before anything is printed
+  SimulationServer* simserver = nullptr;
+  if (server)
+    simserver = new SimulationServer(server_socket == "-" ? G4String("") : server_socket);
+
+  // Construct the run manager and set the initialization classes next.
+  // The factory honours the G4RUN_MANAGER_TYPE and G4FORCENUMBEROFTHREADS
+  // environment variables unless overridden from the command line.
+  G4RunManager* runmgr = G4RunManagerFactory::CreateRunManager(runmgr_type);
+  if (num_threads > 0) runmgr->SetNumberOfThreads(num_threads);
+
+  runmgr->SetUserInitialization(new PhysicsList(physics_mode, uniform_lookups,
+                                                uniform_tolerance));
   runmgr->SetUserInitialization(new DetectorConstruction());
-  runmgr->SetUserAction(new PrimaryGeneration());
-  runmgr->SetUserAction(new RunAction());
-  runmgr->SetUserAction(new SteppingAction());
+  runmgr->SetUserInitialization(new ActionInitialization());
+
+  // Set before the physics is built, so that it needs no UI command
+  G4OpticalParameters::Instance()->SetBoundaryInvokeSD(invoke_sd);
+
+  auto start = std::chrono::steady_clock::now();
   runmgr->Initialize();
+  std::chrono::duration<G4double> elapsed = std::chrono::steady_clock::now() - start;
+
+  G4cout << "Initialization (" << physics_mode << " physics): "
+         << elapsed.count() << " s, peak resident memory "
+         << RunSummary::PeakResidentMemory() << " MB" << G4endl;
 
   G4UImanager * UI = G4UImanager::GetUIpointer();
-  UI->ApplyCommand("/process/optical/boundary/setInvokeSD true");
 
-  // If no macro file was provided via command line,
-  // start an interactive session.
-  if (argc == 1) {
+  if (batch) {
+    // Command-line settings are applied before the macro, which can
+    // still override them
+    G4bool ok = true;
+    if (seed != 0 && !SimulationServer::SetSeed(seed)) {
+      G4cerr << "Cannot set the seed." << G4endl;
+      ok = false;
+    }
+    if (!output.empty()) SimulationServer::SetOutput(output);
+    if (profile_period > 0 &&
+        UI->ApplyCommand("/G4OpSim/profiler/period " +
+                         std::to_string(profile_period)) != fCommandSucceeded) {
+      G4cerr << "Cannot set the step profiler period." << G4endl;
+      ok = false;
+    }
+
+    // Nothing is run if the job is not configured as requested
+    if (ok && !macro.empty()) ok = ExecuteMacro(UI, macro);
+    if (!ok) {
+      delete runmgr;
+      return EXIT_FAILURE;
+    }
+    if (num_events > 0) runmgr->BeamOn(num_events);
+  }
+  else if (server) {
+    // A macro given with the server is run once, before the first job
+    if (!macro.empty() && !ExecuteMacro(UI, macro)) {
+      delete simserver;
+      delete runmgr;
+      return EXIT_FAILURE;
+    }
+    const G4bool served = simserver->Serve(runmgr);
+    delete simserver;
+    if (!served) {
+      delete runmgr;
+      return EXIT_FAILURE;
+    }
+  }
+#ifdef G4OPSIM_WITH_UIVIS
+  else {
+    // Interactive session: vis and the UI terminal are only
+    // instantiated here
     G4VisManager* vismgr = new G4VisExecutive();
     vismgr->Initialize();
     UI->ApplyCommand("/control/execute mac/vis.mac");
@@ -44,12 +291,12 @@ int main(int argc, char const *argv[])
     delete session;
     delete vismgr;
   }
-  // We will assume that the first command-line argument is the name
-  // of a valid macro file. Any other argument will be ignored.
-  else {
-    G4String command = "/control/execute " + std::string(argv[1]);
-    UI->ApplyCommand(command);
-  }
+#endif
+
+  // Worker threads build their physics tables at the first run,
+  // so the job peak includes their share of the memory.
+  G4cout << "Peak resident memory of the job: "
+         << RunSummary::PeakResidentMemory() << " MB" << G4endl;
 
   // Job termination
   // Free the store: user actions, physics_list and detector_description are
@@ -0,0 +1,65 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | bench/BenchReport.h
+//
+//  Collects the results of a benchmark and writes them as JSON to
+//  <benchmark>.json, in the directory given by the G4OPSIM_BENCH_OUTPUT
+//  environment variable (current directory by default):
+//
+//    {"benchmark": "...", "results": [{"name": "...", "value": ..., "unit": "..."}]}
+// -----------------------------------------------------------------------------
+
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+
+class BenchReport
+{
+public:
+  explicit BenchReport(const std::string& benchmark): benchmark_(benchmark) {}
+
+  void Add(const std::string& name, double value, const std::string& unit)
+  { results_.push_back({name, value, unit}); }
+
+  // Returns false if the file cannot be written
+  bool Write() const
+  {
+    const char* dir = std::getenv("G4OPSIM_BENCH_OUTPUT");
+    const std::string path =
+      (dir && *dir ? std::string(dir) + "/" : std::string()) + benchmark_ + ".json";
+
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+      std::fprintf(stderr, "ERROR: cannot write %s\n", path.c_str());
+      return false;
+    }
+
+    std::fprintf(file, "{\n  \"benchmark\": \"%s\",\n  \"results\": [", benchmark_.c_str());
+    for (std::size_t i=0; i<results_.size(); ++i) {
+      std::fprintf(file, "%s\n    {\"name\": \"%s\", \"value\": %.9g, \"unit\": \"%s\"}",
+                   i ? "," : "", results_[i].name.c_str(), results_[i].value,
+                   results_[i].unit.c_str());
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+    std::fclose(file);
+
+    std::printf("Results written to %s\n", path.c_str());
+    return true;
+  }
+
+private:
+  struct Result {
+    std::string name;
+    double value;
+    std::string unit;
+  };
+
+  std::string benchmark_;
+  std::vector<Result> results_;
+};
+
+#endif
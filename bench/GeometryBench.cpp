@@ -0,0 +1,67 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | bench/GeometryBench.cpp
+//
+//  Cost of DetectorConstruction::Construct() (including the overlap checks
+//  and the optical properties) for the single-plate geometry and for a
+//  tiled array of cells. The geometry stores are cleaned between
+//  constructions, as the run manager does when the geometry is rebuilt.
+// -----------------------------------------------------------------------------
+
+#include "DetectorConstruction.h"
+#include "BenchReport.h"
+
+#include <G4UImanager.hh>
+#include <G4PhysicalVolumeStore.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4SolidStore.hh>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace {
+
+  typedef std::chrono::steady_clock Clock;
+
+  // Time per construction (ms)
+  G4double Run(DetectorConstruction& detector, G4int num_repetitions)
+  {
+    G4double elapsed = 0.;
+
+    for (G4int r=0; r<num_repetitions; ++r) {
+      auto start = Clock::now();
+      detector.Construct();
+      elapsed += std::chrono::duration<G4double, std::milli>(Clock::now() - start).count();
+
+      G4PhysicalVolumeStore::Clean();
+      G4LogicalVolumeStore::Clean();
+      G4SolidStore::Clean();
+    }
+
+    return elapsed / num_repetitions;
+  }
+
+} // end namespace
+
+
+int main(int argc, char const *argv[])
+{
+  const G4int num_repetitions = (argc > 1) ? std::atoi(argv[1]) : 10;
+
+  DetectorConstruction detector;
+  G4UImanager* UI = G4UImanager::GetUIpointer();
+  BenchReport report("GeometryBench");
+
+  const G4double t_single = Run(detector, num_repetitions);
+  report.Add("construct_single_cell", t_single, "ms");
+
+  UI->ApplyCommand("/G4OpSim/geometry/numCells 10 10");
+  const G4double t_tiled = Run(detector, num_repetitions);
+  report.Add("construct_10x10_cells", t_tiled, "ms");
+
+  std::printf("Construct(): single cell %8.2f ms, 10x10 cells %8.2f ms\n",
+              t_single, t_tiled);
+
+  return report.Write() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
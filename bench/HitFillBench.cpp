@@ -0,0 +1,88 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | bench/HitFillBench.cpp
+//
+//  Cost of recording detections in an OpticalHit, as done by OpticalSD for
+//  every detected photon: binning into the waveform only, and binning plus
+//  recording of the individual photons (flat binary output enabled).
+//  Detection times follow a LAr-like scintillation profile.
+// -----------------------------------------------------------------------------
+
+#include "OpticalHit.h"
+#include "BenchReport.h"
+
+#include <G4SystemOfUnits.hh>
+
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace {
+
+  typedef std::chrono::steady_clock Clock;
+
+  G4double Elapsed(Clock::time_point start)
+  {
+    return std::chrono::duration<G4double, std::nano>(Clock::now() - start).count();
+  }
+
+  // Time per detection (ns) of filling a new hit with the given times
+  G4double Run(const std::vector<G4double>& times, G4bool record_photons,
+               G4int num_repetitions, G4long& checksum)
+  {
+    G4double elapsed = 0.;
+
+    for (G4int r=0; r<num_repetitions; ++r) {
+      auto start = Clock::now();
+
+      OpticalHit* hit = new OpticalHit();
+      hit->SetTimeBinWidth(1.*ns);
+      hit->SetTimeWindow(10.*microsecond);
+      hit->SetRecordPhotons(record_photons);
+
+      for (G4double t: times) {
+        hit->Fill(t);
+        if (hit->GetRecordPhotons()) hit->AddPhoton(t, 420.*nm);
+      }
+
+      elapsed += Elapsed(start);
+
+      checksum += hit->GetWaveform().size() + hit->GetPhotons().size();
+      delete hit;
+    }
+
+    return elapsed / (G4double(times.size()) * num_repetitions);
+  }
+
+} // end namespace
+
+
+int main(int argc, char const *argv[])
+{
+  const std::size_t num_photons = (argc > 1) ? std::atol(argv[1]) : 20000;
+  const G4int num_repetitions   = (argc > 2) ? std::atoi(argv[2]) : 200;
+
+  std::mt19937_64 rng(12345);
+  std::uniform_real_distribution<G4double> flat(0., 1.);
+  std::exponential_distribution<G4double> fast(1./6.), slow(1./1500.);
+
+  std::vector<G4double> times(num_photons);
+  for (auto& t: times) t = ((flat(rng) < 0.3) ? fast(rng) : slow(rng)) * ns;
+
+  G4long checksum = 0;
+  const G4double t_binned = Run(times, false, num_repetitions, checksum);
+  const G4double t_photons = Run(times, true, num_repetitions, checksum);
+
+  std::printf("Photons per hit: %zu, repetitions: %d (checksum %ld)\n",
+              num_photons, num_repetitions, checksum);
+  std::printf("  waveform only:        %6.2f ns/detection\n", t_binned);
+  std::printf("  waveform and photons: %6.2f ns/detection\n", t_photons);
+
+  BenchReport report("HitFillBench");
+  report.Add("fill_waveform", t_binned, "ns/detection");
+  report.Add("fill_waveform_photons", t_photons, "ns/detection");
+
+  return report.Write() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,81 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | bench/PrimaryGenerationBench.cpp
+//
+//  Cost of PrimaryGeneration::GeneratePrimaries() per generated optical
+//  photon, for a single vertex with isotropic photons of random energy
+//  (photons mode) and for LAr scintillation flashes (flash mode, one vertex
+//  per photon). Events are created and deleted as in a real run. The
+//  photons mode is also timed with the counter-based random streams.
+// -----------------------------------------------------------------------------
+
+#include "PrimaryGeneration.h"
+#include "BenchReport.h"
+
+#include <G4Event.hh>
+#include <G4UImanager.hh>
+#include <Randomize.hh>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace {
+
+  typedef std::chrono::steady_clock Clock;
+
+  // Time per generated photon (ns)
+  G4double Run(PrimaryGeneration& generator, G4int num_events)
+  {
+    G4long num_photons = 0;
+    G4double elapsed = 0.;
+
+    for (G4int i=0; i<num_events; ++i) {
+      auto start = Clock::now();
+      G4Event* event = new G4Event(i);
+      generator.GeneratePrimaries(event);
+      elapsed += std::chrono::duration<G4double, std::nano>(Clock::now() - start).count();
+
+      for (G4int v=0; v<event->GetNumberOfPrimaryVertex(); ++v)
+        num_photons += event->GetPrimaryVertex(v)->GetNumberOfParticle();
+      delete event;
+    }
+
+    return num_photons ? elapsed / num_photons : 0.;
+  }
+
+} // end namespace
+
+
+int main(int argc, char const *argv[])
+{
+  const G4int num_events = (argc > 1) ? std::atoi(argv[1]) : 100;
+
+  G4Random::setTheSeed(12345);
+
+  PrimaryGeneration generator;
+  G4UImanager* UI = G4UImanager::GetUIpointer();
+  BenchReport report("PrimaryGenerationBench");
+
+  UI->ApplyCommand("/G4OpSim/generator/mode photons");
+  UI->ApplyCommand("/G4OpSim/generator/numPhotons 10000");
+  UI->ApplyCommand("/G4OpSim/generator/directionMode isotropic");
+  UI->ApplyCommand("/G4OpSim/generator/energyMode flat");
+  const G4double t_photons = Run(generator, num_events);
+  std::printf("photons mode (10000 per event): %6.2f ns/photon\n", t_photons);
+  report.Add("photons_mode", t_photons, "ns/photon");
+
+  UI->ApplyCommand("/G4OpSim/random/counterBased true");
+  const G4double t_philox = Run(generator, num_events);
+  std::printf("photons mode, counter-based:    %6.2f ns/photon\n", t_philox);
+  report.Add("photons_mode_counter_based", t_philox, "ns/photon");
+  UI->ApplyCommand("/G4OpSim/random/counterBased false");
+
+  UI->ApplyCommand("/G4OpSim/generator/mode flash");
+  UI->ApplyCommand("/G4OpSim/generator/flash/energyDeposit 1 MeV");
+  const G4double t_flash = Run(generator, num_events);
+  std::printf("flash mode (1 MeV per event):   %6.2f ns/photon\n", t_flash);
+  report.Add("flash_mode", t_flash, "ns/photon");
+
+  return report.Write() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
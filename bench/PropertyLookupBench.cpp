@@ -0,0 +1,93 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | bench/PropertyLookupBench.cpp
+//
+//  Compares the cost of looking up a material property through
+//  G4MaterialPropertyVector::Value() (binary search on the tabulated
+//  energies) with that of UniformPropertyVector::Value() (uniform grid,
+//  constant time), for the WLS absorption length of the plate and the
+//  SiPM efficiency. Photon energies are random, as in the photon hot loop,
+//  where consecutive lookups rarely fall in the same bin.
+// -----------------------------------------------------------------------------
+
+#include "UniformPropertyVector.h"
+#include "PropertyLoader.h"
+#include "BenchReport.h"
+
+#include <G4SystemOfUnits.hh>
+
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace {
+
+  typedef std::chrono::steady_clock Clock;
+
+  G4double Elapsed(Clock::time_point start)
+  {
+    return std::chrono::duration<G4double, std::nano>(Clock::now() - start).count();
+  }
+
+  void Run(const char* name, const PropertyLoader::Spectrum& spectrum,
+           const std::vector<G4double>& energies, G4int num_repetitions,
+           BenchReport& report)
+  {
+    G4MaterialPropertyVector vec(spectrum.energies.data(), spectrum.values.data(),
+                                 spectrum.energies.size());
+    UniformPropertyVector uniform(vec);
+
+    G4double t_vec = 0., t_uniform = 0., sum_vec = 0., sum_uniform = 0.;
+
+    for (G4int r=0; r<num_repetitions; ++r) {
+      auto start = Clock::now();
+      for (G4double e: energies) sum_vec += vec.Value(e);
+      t_vec += Elapsed(start);
+
+      start = Clock::now();
+      for (G4double e: energies) sum_uniform += uniform.Value(e);
+      t_uniform += Elapsed(start);
+    }
+
+    const G4double n = G4double(energies.size()) * num_repetitions;
+
+    std::printf("%-14s %5zu entries -> %6d bins (max rel. error %.1e)\n"
+                "  G4MaterialPropertyVector: %6.2f ns/lookup\n"
+                "  UniformPropertyVector:    %6.2f ns/lookup (x%.1f)\n"
+                "  checksum ratio: %.6f\n",
+                name, spectrum.energies.size(), uniform.GetNumBins(),
+                uniform.GetMaxError(), t_vec/n, t_uniform/n, t_vec/t_uniform,
+                sum_uniform/sum_vec);
+
+    report.Add(std::string(name) + "_G4MaterialPropertyVector", t_vec/n, "ns/lookup");
+    report.Add(std::string(name) + "_UniformPropertyVector", t_uniform/n, "ns/lookup");
+  }
+
+} // end namespace
+
+
+int main(int argc, char const *argv[])
+{
+  const std::size_t num_lookups = (argc > 1) ? std::atol(argv[1]) : 100000;
+  const G4int num_repetitions   = (argc > 2) ? std::atoi(argv[2]) : 100;
+
+  std::mt19937_64 rng(12345);
+  std::uniform_real_distribution<G4double> flat(1.5*eV, 4.5*eV);
+  std::vector<G4double> energies(num_lookups);
+  for (auto& e: energies) e = flat(rng);
+
+  BenchReport report("PropertyLookupBench");
+
+  Run("WLSABSLENGTH",
+      PropertyLoader::Load("pvt_wlsabslength.csv", PropertyLoader::kEnergy, eV, mm),
+      energies, num_repetitions, report);
+
+  Run("EFFICIENCY",
+      PropertyLoader::Load("sipm_pde_vs_wavelength(nm).csv",
+                           PropertyLoader::kWavelength, nm, 0.01),
+      energies, num_repetitions, report);
+
+  return report.Write() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
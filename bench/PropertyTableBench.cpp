@@ -0,0 +1,64 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | bench/PropertyTableBench.cpp
+//
+//  Cost of building the material properties tables of
+//  OpticalMaterialProperties, which parse (or read from the binary cache)
+//  the tabulated spectra in data/. The first construction of every table
+//  fills the cache; the following ones are served from it.
+// -----------------------------------------------------------------------------
+
+#include "OpticalMaterialProperties.h"
+#include "BenchReport.h"
+
+#include <G4MaterialPropertiesTable.hh>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace {
+
+  typedef std::chrono::steady_clock Clock;
+
+  G4double Elapsed(Clock::time_point start)
+  {
+    return std::chrono::duration<G4double, std::micro>(Clock::now() - start).count();
+  }
+
+  void Run(const char* name, G4MaterialPropertiesTable* (*build)(),
+           G4int num_repetitions, BenchReport& report)
+  {
+    auto start = Clock::now();
+    delete build();
+    const G4double t_first = Elapsed(start);
+
+    start = Clock::now();
+    for (G4int r=0; r<num_repetitions; ++r) delete build();
+    const G4double t_next = Elapsed(start) / num_repetitions;
+
+    std::printf("%-12s first: %9.1f us, next: %9.1f us\n", name, t_first, t_next);
+
+    report.Add(std::string(name) + "_first", t_first, "us");
+    report.Add(std::string(name), t_next, "us");
+  }
+
+} // end namespace
+
+
+int main(int argc, char const *argv[])
+{
+  const G4int num_repetitions = (argc > 1) ? std::atoi(argv[1]) : 100;
+
+  BenchReport report("PropertyTableBench");
+
+  Run("LAr",         &OpticalMaterialProperties::LAr,         num_repetitions, report);
+  Run("PVT",         &OpticalMaterialProperties::PVT,         num_repetitions, report);
+  Run("BC418",       &OpticalMaterialProperties::BC418,       num_repetitions, report);
+  Run("PTP",         &OpticalMaterialProperties::PTP,         num_repetitions, report);
+  Run("VIKUITI",     &OpticalMaterialProperties::VIKUITI,     num_repetitions, report);
+  Run("FusedSilica", &OpticalMaterialProperties::FusedSilica, num_repetitions, report);
+  Run("GlassEpoxy",  &OpticalMaterialProperties::GlassEpoxy,  num_repetitions, report);
+
+  return report.Write() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
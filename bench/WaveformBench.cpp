@@ -0,0 +1,102 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | bench/WaveformBench.cpp
+//
+//  Compares the cost of filling and iterating the Waveform container used by
+//  OpticalHit with that of the std::map<G4double, G4int> it replaced.
+//  Detection times follow a LAr-like scintillation profile (fast and slow
+//  exponential components), binned in 1-ns bins over a 10-us window.
+// -----------------------------------------------------------------------------
+
+#include "Waveform.h"
+#include "BenchReport.h"
+
+#include <map>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace {
+
+  typedef std::chrono::steady_clock Clock;
+
+  G4double Elapsed(Clock::time_point start)
+  {
+    return std::chrono::duration<G4double, std::nano>(Clock::now() - start).count();
+  }
+
+  std::vector<G4double> DetectionTimes(std::size_t n, unsigned seed)
+  {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<G4double> flat(0., 1.);
+    std::exponential_distribution<G4double> fast(1./6.), slow(1./1500.);
+
+    std::vector<G4double> times(n);
+    for (auto& t: times) t = (flat(rng) < 0.3) ? fast(rng) : slow(rng);
+    return times;
+  }
+
+} // end namespace
+
+
+int main(int argc, char const *argv[])
+{
+  const std::size_t num_photons = (argc > 1) ? std::atol(argv[1]) : 20000;
+  const G4int num_repetitions   = (argc > 2) ? std::atoi(argv[2]) : 200;
+
+  const G4double bin_width = 1.;    // ns
+  const G4double window    = 10000.; // ns
+
+  const std::vector<G4double> times = DetectionTimes(num_photons, 12345);
+
+  G4double map_fill = 0., map_iter = 0., wvf_fill = 0., wvf_iter = 0.;
+  G4long checksum_map = 0, checksum_wvf = 0;
+
+  for (G4int r=0; r<num_repetitions; ++r) {
+
+    // std::map keyed by the low edge of the time bin (former implementation)
+    auto start = Clock::now();
+    std::map<G4double, G4int> map;
+    for (G4double t: times) map[std::floor(t/bin_width)*bin_width] += 1;
+    map_fill += Elapsed(start);
+
+    start = Clock::now();
+    for (const auto& bin: map) checksum_map += bin.second * (1 + (G4long) bin.first);
+    map_iter += Elapsed(start);
+
+    // Dense + sparse binned container
+    start = Clock::now();
+    Waveform wvf(bin_width, window);
+    for (G4double t: times) wvf.Fill(t);
+    wvf_fill += Elapsed(start);
+
+    start = Clock::now();
+    for (const auto& bin: wvf) checksum_wvf += bin.second * (1 + (G4long) bin.first);
+    wvf_iter += Elapsed(start);
+  }
+
+  if (checksum_map != checksum_wvf) {
+    std::fprintf(stderr, "ERROR: the containers hold different contents.\n");
+    return EXIT_FAILURE;
+  }
+
+  const G4double nfills = G4double(num_photons) * num_repetitions;
+
+  std::printf("Photons per waveform: %zu, repetitions: %d\n",
+              num_photons, num_repetitions);
+  std::printf("%-12s %16s %20s\n", "container", "fill [ns/photon]", "iteration [us/waveform]");
+  std::printf("%-12s %16.2f %20.2f\n", "std::map",
+              map_fill/nfills, map_iter/num_repetitions/1000.);
+  std::printf("%-12s %16.2f %20.2f\n", "Waveform",
+              wvf_fill/nfills, wvf_iter/num_repetitions/1000.);
+
+  BenchReport report("WaveformBench");
+  report.Add("map_fill",       map_fill/nfills,                  "ns/photon");
+  report.Add("map_iteration",  map_iter/num_repetitions/1000.,   "us/waveform");
+  report.Add("waveform_fill",  wvf_fill/nfills,                  "ns/photon");
+  report.Add("waveform_iteration", wvf_iter/num_repetitions/1000., "us/waveform");
+
+  return report.Write() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
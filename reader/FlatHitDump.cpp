@@ -0,0 +1,58 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | reader/FlatHitDump.cpp
+//
+//  Example use of the flat hit reader: prints a summary of a file and,
+//  optionally, its first records.
+// -----------------------------------------------------------------------------
+
+#include "FlatHitReader.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+
+int main(int argc, char const *argv[])
+{
+  if (argc < 2) {
+    std::fprintf(stderr, "Usage: %s <file> [num_records]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const std::size_t num_print = (argc > 2) ? std::atol(argv[2]) : 0;
+
+  try {
+    FlatHitReader reader(argv[1]);
+
+    std::printf("%s: %llu photon hits in %zu blocks\n", argv[1],
+                (unsigned long long) reader.GetNumberOfRows(),
+                reader.GetNumberOfBlocks());
+
+    std::size_t printed = 0;
+    double sum_time = 0., sum_wavelength = 0.;
+
+    reader.ForEachBlock([&](const FlatHitBlock& block) {
+      for (std::size_t i=0; i<block.size(); ++i) {
+        sum_time += block.time[i];
+        sum_wavelength += block.wavelength[i];
+        if (printed < num_print) {
+          std::printf("%8d %6d %12.3f %10.2f\n", block.event_id[i],
+                      block.sensor_id[i], block.time[i], block.wavelength[i]);
+          ++printed;
+        }
+      }
+    });
+
+    if (reader.GetNumberOfRows() > 0) {
+      std::printf("mean arrival time: %.3f ns, mean wavelength: %.2f nm\n",
+                  sum_time / reader.GetNumberOfRows(),
+                  sum_wavelength / reader.GetNumberOfRows());
+    }
+  }
+  catch (const std::exception& e) {
+    std::fprintf(stderr, "ERROR: %s\n", e.what());
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | reader/FlatHitReader.cpp
+//
+//  Zero-copy reader of the flat binary hit files written by G4OpSim.
+// -----------------------------------------------------------------------------
+
+#include "FlatHitReader.h"
+
+#include <stdexcept>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+static_assert(FlatHitFormat::kHostIsLittleEndian,
+              "Flat hit files are little-endian; big-endian hosts are not supported.");
+
+
+FlatHitReader::FlatHitReader(const std::string& filename):
+  data_(nullptr), size_(0), index_(nullptr), trailer_()
+{
+  using namespace FlatHitFormat;
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("Cannot open " + filename);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("Cannot stat " + filename);
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+
+  if (size_ < sizeof(FileHeader) + sizeof(FileTrailer)) {
+    close(fd);
+    throw std::runtime_error(filename + " is too small to be a flat hit file");
+  }
+
+  void* addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping remains valid
+  if (addr == MAP_FAILED) throw std::runtime_error("Cannot map " + filename);
+
+  data_ = static_cast<const unsigned char*>(addr);
+  madvise(addr, size_, MADV_SEQUENTIAL);
+
+  // Validate header and trailer
+  FileHeader header;
+  std::memcpy(&header, data_, sizeof(header));
+  std::memcpy(&trailer_, data_ + size_ - sizeof(FileTrailer), sizeof(trailer_));
+
+  const char* error = nullptr;
+
+  if (std::memcmp(header.magic, kHeaderMagic, sizeof(header.magic)) != 0)
+    error = "bad header (not a flat hit file?)";
+  else if (header.version != kVersion || header.num_columns != kNumColumns)
+    error = "unsupported format version";
+  else if (std::memcmp(trailer_.magic, kTrailerMagic, sizeof(trailer_.magic)) != 0)
+    error = "bad trailer (file truncated?)";
+  else if (trailer_.index_offset + trailer_.num_blocks * sizeof(BlockIndexEntry)
+           + sizeof(FileTrailer) != size_)
+    error = "inconsistent block index";
+
+  if (!error) {
+    index_ = reinterpret_cast<const BlockIndexEntry*>(data_ + trailer_.index_offset);
+    for (std::size_t i=0; i<trailer_.num_blocks; ++i) {
+      if (index_[i].offset + BlockSize(index_[i].num_rows) > trailer_.index_offset) {
+        error = "block extends beyond the block index";
+        break;
+      }
+    }
+  }
+
+  if (error) {
+    munmap(addr, size_);
+    data_ = nullptr;
+    throw std::runtime_error(filename + ": " + error);
+  }
+}
+
+
+FlatHitReader::~FlatHitReader()
+{
+  if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+
+FlatHitBlock FlatHitReader::GetBlock(std::size_t i) const
+{
+  using namespace FlatHitFormat;
+
+  if (i >= GetNumberOfBlocks()) throw std::out_of_range("FlatHitReader::GetBlock");
+
+  const std::size_t n = index_[i].num_rows;
+  const unsigned char* block = data_ + index_[i].offset;
+
+  FlatHitBlock b;
+  b.event_id = Span<std::int32_t>(
+    reinterpret_cast<const std::int32_t*>(block + ColumnOffset(kEventID, n)), n);
+  b.sensor_id = Span<std::int32_t>(
+    reinterpret_cast<const std::int32_t*>(block + ColumnOffset(kSensorID, n)), n);
+  b.time = Span<float>(
+    reinterpret_cast<const float*>(block + ColumnOffset(kTime, n)), n);
+  b.wavelength = Span<float>(
+    reinterpret_cast<const float*>(block + ColumnOffset(kWavelength, n)), n);
+
+  return b;
+}
@@ -0,0 +1,94 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | reader/FlatHitReader.h
+//
+//  Zero-copy reader of the flat binary hit files written by G4OpSim
+//  (see src/FlatHitFormat.h). The file is memory-mapped and every block
+//  is exposed as a set of read-only spans over its columns, so that no
+//  data is copied or deserialized. Independent of Geant4.
+// -----------------------------------------------------------------------------
+
+#ifndef FLAT_HIT_READER_H
+#define FLAT_HIT_READER_H
+
+#include "FlatHitFormat.h"
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+// Minimal read-only view over a contiguous array
+template <typename T>
+class Span
+{
+public:
+  Span(): data_(nullptr), size_(0) {}
+  Span(const T* data, std::size_t size): data_(data), size_(size) {}
+
+  const T* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const T& operator[](std::size_t i) const { return data_[i]; }
+
+  const T* begin() const { return data_; }
+  const T* end() const { return data_ + size_; }
+
+private:
+  const T* data_;
+  std::size_t size_;
+};
+
+
+struct FlatHitBlock
+{
+  Span<std::int32_t> event_id;
+  Span<std::int32_t> sensor_id;
+  Span<float> time;       // ns
+  Span<float> wavelength; // nm
+
+  std::size_t size() const { return event_id.size(); }
+};
+
+
+class FlatHitReader
+{
+public:
+  // Map the given file in memory and validate its header, trailer
+  // and block index. Throws std::runtime_error on failure.
+  explicit FlatHitReader(const std::string& filename);
+  ~FlatHitReader();
+
+  FlatHitReader(const FlatHitReader&) = delete;
+  FlatHitReader& operator=(const FlatHitReader&) = delete;
+
+  std::size_t GetNumberOfBlocks() const;
+  std::uint64_t GetNumberOfRows() const;
+
+  FlatHitBlock GetBlock(std::size_t i) const;
+
+  // Call f(block) for every block, in file order
+  template <typename F> void ForEachBlock(F f) const;
+
+private:
+  const unsigned char* data_;
+  std::size_t size_;
+  const FlatHitFormat::BlockIndexEntry* index_;
+  FlatHitFormat::FileTrailer trailer_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+inline std::size_t FlatHitReader::GetNumberOfBlocks() const
+{ return trailer_.num_blocks; }
+
+inline std::uint64_t FlatHitReader::GetNumberOfRows() const
+{ return trailer_.num_rows; }
+
+template <typename F>
+void FlatHitReader::ForEachBlock(F f) const
+{
+  for (std::size_t i=0; i<GetNumberOfBlocks(); ++i) f(GetBlock(i));
+}
+
+#endif
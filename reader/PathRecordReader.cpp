@@ -0,0 +1,74 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | reader/PathRecordReader.cpp
+//
+//  Zero-copy reader of the photon path files written by G4OpSim.
+// -----------------------------------------------------------------------------
+
+#include "PathRecordReader.h"
+
+#include <stdexcept>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+static_assert(PathRecordFormat::kHostIsLittleEndian,
+              "Photon path files are little-endian; big-endian hosts are not supported.");
+
+
+PathRecordReader::PathRecordReader(const std::string& filename):
+  data_(nullptr), size_(0), header_(), records_()
+{
+  using namespace PathRecordFormat;
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("Cannot open " + filename);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("Cannot stat " + filename);
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+
+  if (size_ < sizeof(FileHeader)) {
+    close(fd);
+    throw std::runtime_error(filename + " is too small to be a photon path file");
+  }
+
+  void* addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping remains valid
+  if (addr == MAP_FAILED) throw std::runtime_error("Cannot map " + filename);
+
+  data_ = static_cast<const unsigned char*>(addr);
+  madvise(addr, size_, MADV_SEQUENTIAL);
+
+  std::memcpy(&header_, data_, sizeof(header_));
+
+  const char* error = nullptr;
+
+  if (std::memcmp(header_.magic, kHeaderMagic, sizeof(header_.magic)) != 0)
+    error = "bad header (not a photon path file?)";
+  else if (header_.version != kVersion || header_.num_surfaces != kNumSurfaces)
+    error = "unsupported format version";
+  else if (sizeof(FileHeader) + header_.num_records * sizeof(Record) != size_)
+    error = "inconsistent number of records (file not closed?)";
+
+  if (error) {
+    munmap(addr, size_);
+    data_ = nullptr;
+    throw std::runtime_error(filename + ": " + error);
+  }
+
+  records_ = Span<Record>(
+    reinterpret_cast<const Record*>(data_ + sizeof(FileHeader)), header_.num_records);
+}
+
+
+PathRecordReader::~PathRecordReader()
+{
+  if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+}
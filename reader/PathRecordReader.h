@@ -0,0 +1,51 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | reader/PathRecordReader.h
+//
+//  Zero-copy reader of the photon path files written by G4OpSim
+//  (see src/PathRecordFormat.h). The file is memory-mapped and its records
+//  are exposed as a read-only span. Independent of Geant4.
+// -----------------------------------------------------------------------------
+
+#ifndef PATH_RECORD_READER_H
+#define PATH_RECORD_READER_H
+
+#include "PathRecordFormat.h"
+#include "FlatHitReader.h" // Span
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+class PathRecordReader
+{
+public:
+  // Map the given file in memory and validate its header.
+  // Throws std::runtime_error on failure.
+  explicit PathRecordReader(const std::string& filename);
+  ~PathRecordReader();
+
+  PathRecordReader(const PathRecordReader&) = delete;
+  PathRecordReader& operator=(const PathRecordReader&) = delete;
+
+  // Number of primary photons of all the simulated events
+  std::uint64_t GetNumberOfEmitted() const;
+
+  const Span<PathRecordFormat::Record>& GetRecords() const;
+
+private:
+  const unsigned char* data_;
+  std::size_t size_;
+  PathRecordFormat::FileHeader header_;
+  Span<PathRecordFormat::Record> records_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+inline std::uint64_t PathRecordReader::GetNumberOfEmitted() const
+{ return header_.num_emitted; }
+
+inline const Span<PathRecordFormat::Record>& PathRecordReader::GetRecords() const
+{ return records_; }
+
+#endif
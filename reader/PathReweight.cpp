@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | reader/PathReweight.cpp
+//
+//  Detection efficiency of a photon path file (see PathReweighter.h)
+//  reweighted for the given foil reflectivity and sensor efficiency curves.
+// -----------------------------------------------------------------------------
+
+#include "PathRecordReader.h"
+#include "PathReweighter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+
+
+namespace {
+
+  void PrintUsage(const char* program)
+  {
+    std::fprintf(stderr,
+      "Usage: %s [options] <path file>\n"
+      "  --pde <csv>                 sensor efficiency vs wavelength (nm)\n"
+      "  --pde-scale <s>             factor applied to the efficiency values\n"
+      "                              (default 0.01: file in %%)\n"
+      "  --reflectivity <csv>        reflectivity vs wavelength (nm), all foils\n"
+      "  --bottom-reflectivity <csv> reflectivity of the bottom foil only\n"
+      "  --side-reflectivity <csv>   reflectivity of the side foils only\n"
+      "  --sensors                   print the reweighted counts per sensor\n"
+      "Curves not given are taken as 1.\n", program);
+  }
+
+} // namespace
+
+
+int main(int argc, char const *argv[])
+{
+  const char* path_file = nullptr;
+  const char* pde_file = nullptr;
+  const char* reflectivity_file[PathRecordFormat::kNumSurfaces] = {nullptr, nullptr};
+  double pde_scale = 0.01;
+  bool print_sensors = false;
+
+  for (int i=1; i<argc; ++i) {
+    const bool has_value = (i + 1 < argc);
+    if (!std::strcmp(argv[i], "--pde") && has_value) {
+      pde_file = argv[++i];
+    }
+    else if (!std::strcmp(argv[i], "--pde-scale") && has_value) {
+      pde_scale = std::atof(argv[++i]);
+    }
+    else if (!std::strcmp(argv[i], "--reflectivity") && has_value) {
+      reflectivity_file[PathRecordFormat::kBottomFoil] = argv[++i];
+      reflectivity_file[PathRecordFormat::kSideFoil] = argv[i];
+    }
+    else if (!std::strcmp(argv[i], "--bottom-reflectivity") && has_value) {
+      reflectivity_file[PathRecordFormat::kBottomFoil] = argv[++i];
+    }
+    else if (!std::strcmp(argv[i], "--side-reflectivity") && has_value) {
+      reflectivity_file[PathRecordFormat::kSideFoil] = argv[++i];
+    }
+    else if (!std::strcmp(argv[i], "--sensors")) {
+      print_sensors = true;
+    }
+    else if (argv[i][0] != '-' && !path_file) {
+      path_file = argv[i];
+    }
+    else {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!path_file) {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  try {
+    PathReweighter reweighter;
+
+    if (pde_file) {
+      // As in the simulation, no detection outside the tabulated range
+      WavelengthCurve pde = WavelengthCurve::Load(pde_file, pde_scale);
+      pde.SetZeroOutside(true);
+      reweighter.SetEfficiency(pde);
+    }
+
+    for (int s=0; s<PathRecordFormat::kNumSurfaces; ++s) {
+      if (!reflectivity_file[s]) continue;
+      reweighter.SetReflectivity(PathRecordFormat::Surface(s),
+                                 WavelengthCurve::Load(reflectivity_file[s]));
+    }
+
+    PathRecordReader reader(path_file);
+    const PathReweighter::Result result = reweighter.Reweight(reader);
+
+    std::printf("%s: %llu photon paths, %llu photons emitted\n", path_file,
+                (unsigned long long) result.num_records,
+                (unsigned long long) result.num_emitted);
+    std::printf("reweighted detections: %.3f (efficiency %.6g)\n",
+                result.detected, result.GetEfficiency());
+
+    if (print_sensors) {
+      for (std::size_t i=0; i<result.sensors.size(); ++i)
+        std::printf("%6zu %12.3f\n", i, result.sensors[i]);
+    }
+  }
+  catch (const std::exception& e) {
+    std::fprintf(stderr, "ERROR: %s\n", e.what());
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
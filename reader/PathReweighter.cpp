@@ -0,0 +1,150 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | reader/PathReweighter.cpp
+//
+//  Detection efficiency for alternative reflectivities and sensor
+//  efficiencies, computed from photon path records.
+// -----------------------------------------------------------------------------
+
+#include "PathReweighter.h"
+#include "PathRecordReader.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <cmath>
+
+
+WavelengthCurve::WavelengthCurve(double value):
+  wavelengths_(1, 0.), values_(1, value), zero_outside_(false)
+{
+}
+
+
+WavelengthCurve::WavelengthCurve(const std::vector<double>& wavelengths,
+                                 const std::vector<double>& values):
+  zero_outside_(false)
+{
+  if (wavelengths.empty() || wavelengths.size() != values.size())
+    throw std::invalid_argument("WavelengthCurve: bad number of points");
+
+  std::vector<std::size_t> order(wavelengths.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](std::size_t a, std::size_t b) { return wavelengths[a] < wavelengths[b]; });
+
+  for (std::size_t i: order) {
+    wavelengths_.push_back(wavelengths[i]);
+    values_.push_back(values[i]);
+  }
+}
+
+
+WavelengthCurve WavelengthCurve::Load(const std::string& filename, double scale)
+{
+  std::ifstream in(filename);
+  if (!in) throw std::runtime_error("Cannot open " + filename);
+
+  std::vector<double> wavelengths, values;
+  std::string line;
+  std::size_t line_number = 0;
+
+  while (std::getline(in, line)) {
+    ++line_number;
+    line = line.substr(0, line.find('#'));
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream ss(line);
+    double wavelength, value;
+    if (!(ss >> wavelength >> value))
+      throw std::runtime_error(filename + ":" + std::to_string(line_number) +
+                               ": expected 'wavelength, value'");
+    wavelengths.push_back(wavelength);
+    values.push_back(value * scale);
+  }
+
+  if (wavelengths.empty()) throw std::runtime_error(filename + ": no data");
+
+  return WavelengthCurve(wavelengths, values);
+}
+
+
+void WavelengthCurve::SetZeroOutside(bool zero) { zero_outside_ = zero; }
+
+
+double WavelengthCurve::operator()(double wavelength) const
+{
+  if (wavelength <= wavelengths_.front()) {
+    if (zero_outside_ && wavelength < wavelengths_.front()) return 0.;
+    return values_.front();
+  }
+  if (wavelength >= wavelengths_.back()) {
+    if (zero_outside_ && wavelength > wavelengths_.back()) return 0.;
+    return values_.back();
+  }
+
+  const std::size_t i =
+    std::upper_bound(wavelengths_.begin(), wavelengths_.end(), wavelength)
+    - wavelengths_.begin();
+
+  const double f = (wavelength - wavelengths_[i-1]) / (wavelengths_[i] - wavelengths_[i-1]);
+  return values_[i-1] + f * (values_[i] - values_[i-1]);
+}
+
+
+PathReweighter::PathReweighter()
+{
+}
+
+
+void PathReweighter::SetReflectivity(PathRecordFormat::Surface surface,
+                                     const WavelengthCurve& curve)
+{
+  reflectivity_[surface] = curve;
+}
+
+
+void PathReweighter::SetEfficiency(const WavelengthCurve& curve)
+{
+  efficiency_ = curve;
+}
+
+
+double PathReweighter::Weight(const PathRecordFormat::Record& record) const
+{
+  using namespace PathRecordFormat;
+
+  double weight = efficiency_(record.detected_wavelength);
+
+  for (int s=0; s<kNumSurfaces; ++s) {
+    const std::uint16_t* n = record.reflections[s];
+    if (n[kBeforeWLS] > 0)
+      weight *= std::pow(reflectivity_[s](record.emitted_wavelength), n[kBeforeWLS]);
+    if (n[kAfterWLS] > 0)
+      weight *= std::pow(reflectivity_[s](record.detected_wavelength), n[kAfterWLS]);
+  }
+
+  return weight;
+}
+
+
+PathReweighter::Result PathReweighter::Reweight(const PathRecordReader& reader) const
+{
+  Result result;
+  result.num_emitted = reader.GetNumberOfEmitted();
+  result.num_records = reader.GetRecords().size();
+  result.detected = 0.;
+
+  for (const PathRecordFormat::Record& record: reader.GetRecords()) {
+    if (record.sensor_id < 0) continue;
+    const double weight = Weight(record);
+    result.detected += weight;
+    if (static_cast<std::size_t>(record.sensor_id) >= result.sensors.size())
+      result.sensors.resize(record.sensor_id + 1, 0.);
+    result.sensors[record.sensor_id] += weight;
+  }
+
+  return result;
+}
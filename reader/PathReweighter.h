@@ -0,0 +1,84 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | reader/PathReweighter.h
+//
+//  Detection efficiency for alternative foil reflectivities and sensor
+//  efficiencies, computed from photon path records (see PathRecordReader.h)
+//  of a simulation run with both set to 1 (/G4OpSim/geometry/
+//  unitEfficiencies). Every recorded photon is weighted with the
+//  probability of surviving its reflections and being detected:
+//
+//    w = PDE(l_det) * prod_s R_s(l_emit)^n_s,before * R_s(l_det)^n_s,after
+//
+//  Photons shifted more than once are reweighted as if every reflection
+//  after the first WLS had happened at the detected wavelength.
+//  Independent of Geant4.
+// -----------------------------------------------------------------------------
+
+#ifndef PATH_REWEIGHTER_H
+#define PATH_REWEIGHTER_H
+
+#include "PathRecordFormat.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class PathRecordReader;
+
+
+// Property as a function of wavelength (nm), linearly interpolated
+// between its points and constant beyond the first and last ones
+class WavelengthCurve
+{
+public:
+  explicit WavelengthCurve(double value=1.);
+  WavelengthCurve(const std::vector<double>& wavelengths,
+                  const std::vector<double>& values);
+
+  // Read a CSV file with one 'wavelength, value' pair per line ('#' for
+  // comments), as those in data/, multiplying the values by the given
+  // scale (e.g. 0.01 for percentages). Throws std::runtime_error.
+  static WavelengthCurve Load(const std::string& filename, double scale=1.);
+
+  // Zero instead of constant beyond the first and last points (as the
+  // sensor efficiency in the simulation)
+  void SetZeroOutside(bool);
+
+  double operator()(double wavelength) const;
+
+private:
+  std::vector<double> wavelengths_, values_; // sorted by wavelength
+  bool zero_outside_;
+};
+
+
+class PathReweighter
+{
+public:
+  struct Result {
+    std::uint64_t num_emitted;
+    std::uint64_t num_records;
+    double detected;              // sum of weights
+    std::vector<double> sensors;  // sum of weights per sensor ID
+
+    double GetEfficiency() const
+    { return num_emitted > 0 ? detected / num_emitted : 0.; }
+  };
+
+  // By default all reflectivities and the efficiency are 1
+  PathReweighter();
+
+  void SetReflectivity(PathRecordFormat::Surface, const WavelengthCurve&);
+  void SetEfficiency(const WavelengthCurve&);
+
+  // Probability that the photon of the record would have been detected
+  double Weight(const PathRecordFormat::Record&) const;
+
+  Result Reweight(const PathRecordReader&) const;
+
+private:
+  WavelengthCurve reflectivity_[PathRecordFormat::kNumSurfaces];
+  WavelengthCurve efficiency_;
+};
+
+#endif
@@ -0,0 +1,49 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | ActionInitialization.cpp
+//
+//  Instantiates the user action classes for the master and worker threads.
+// -----------------------------------------------------------------------------
+
+#include "ActionInitialization.h"
+
+#include "PrimaryGeneration.h"
+#include "RunAction.h"
+#include "EventAction.h"
+#include "SteppingAction.h"
+#include "StackingAction.h"
+#include "KillCounters.h"
+#include "PhotonFate.h"
+#include "StepProfiler.h"
+#include "SensorCounts.h"
+
+
+void ActionInitialization::BuildForMaster() const
+{
+  // The master thread does not process events: it only needs
+  // a run action to handle the beginning and end of the run.
+  SetUserAction(new RunAction(new KillCounters(), new PhotonFate(),
+                              new StepProfiler(), new SensorCounts()));
+}
+
+
+void ActionInitialization::Build() const
+{
+  // Every worker thread (or the only thread in sequential mode)
+  // gets its own instances of the user actions.
+  KillCounters* kill_counters = new KillCounters();
+  StackingAction* stacking_action = new StackingAction(kill_counters);
+  PhotonFate* photon_fate = new PhotonFate();
+  StepProfiler* step_profiler = new StepProfiler();
+  SensorCounts* sensor_counts = new SensorCounts();
+  SteppingAction* stepping_action =
+    new SteppingAction(stacking_action, kill_counters, photon_fate, step_profiler);
+  PrimaryGeneration* generator = new PrimaryGeneration();
+
+  SetUserAction(generator);
+  SetUserAction(new RunAction(kill_counters, photon_fate, step_profiler,
+                              sensor_counts, stepping_action, stacking_action,
+                              generator));
+  SetUserAction(new EventAction(generator, sensor_counts));
+  SetUserAction(stacking_action);
+  SetUserAction(stepping_action);
+}
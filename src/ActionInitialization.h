@@ -0,0 +1,25 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | ActionInitialization.h
+//
+//  Instantiates the user action classes for the master and worker threads.
+// -----------------------------------------------------------------------------
+
+#ifndef ACTION_INITIALIZATION_H
+#define ACTION_INITIALIZATION_H
+
+#include <G4VUserActionInitialization.hh>
+
+
+class ActionInitialization: public G4VUserActionInitialization
+{
+public:
+  ActionInitialization();
+  ~ActionInitialization();
+  void BuildForMaster() const override;
+  void Build() const override;
+};
+
+inline ActionInitialization::ActionInitialization() {}
+inline ActionInitialization::~ActionInitialization() {}
+
+#endif
@@ -0,0 +1,108 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | AliasTable.cpp
+//
+//  Walker's alias method for sampling a discrete distribution in constant
+//  time (Vose's construction).
+// -----------------------------------------------------------------------------
+
+#include "AliasTable.h"
+
+#include <globals.hh>
+
+
+AliasTable::AliasTable()
+{
+}
+
+
+AliasTable::AliasTable(const std::vector<G4double>& weights)
+{
+  Build(weights);
+}
+
+
+AliasTable::~AliasTable()
+{
+}
+
+
+void AliasTable::Build(const std::vector<G4double>& weights)
+{
+  const std::size_t n = weights.size();
+
+  G4double sum = 0.;
+  for (G4double w: weights) {
+    if (w < 0.) {
+      G4Exception("AliasTable::Build()", "AliasTable", FatalErrorInArgument,
+                  "Weights must be non-negative.");
+      return;
+    }
+    sum += w;
+  }
+
+  if (n == 0 || !(sum > 0.)) {
+    G4Exception("AliasTable::Build()", "AliasTable", FatalErrorInArgument,
+                "At least one weight must be positive.");
+    return;
+  }
+
+  threshold_.assign(n, 1.);
+  alias_.resize(n);
+  for (std::size_t i=0; i<n; ++i) alias_[i] = i;
+
+  // Scale the probabilities so that their mean is 1 and split the
+  // outcomes in those below (small) and above (large) the mean.
+  std::vector<G4double> scaled(n);
+  std::vector<std::size_t> small, large;
+  small.reserve(n);
+  large.reserve(n);
+
+  for (std::size_t i=0; i<n; ++i) {
+    scaled[i] = weights[i] * n / sum;
+    if (scaled[i] < 1.) small.push_back(i);
+    else large.push_back(i);
+  }
+
+  // Every small outcome is topped up with probability from a large one
+  while (!small.empty() && !large.empty()) {
+    std::size_t s = small.back(); small.pop_back();
+    std::size_t l = large.back();
+
+    threshold_[s] = scaled[s];
+    alias_[s] = l;
+
+    scaled[l] -= (1. - scaled[s]);
+    if (scaled[l] < 1.) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+
+  // Left-overs are (up to rounding errors) exactly at the mean
+  for (std::size_t i: small) threshold_[i] = 1.;
+  for (std::size_t i: large) threshold_[i] = 1.;
+}
+
+
+AliasHistogram::AliasHistogram()
+{
+}
+
+
+AliasHistogram::~AliasHistogram()
+{
+}
+
+
+void AliasHistogram::Build(const std::vector<G4double>& edges,
+                           const std::vector<G4double>& contents)
+{
+  if (edges.size() != contents.size() + 1) {
+    G4Exception("AliasHistogram::Build()", "AliasTable", FatalErrorInArgument,
+                "The number of edges must be the number of bins plus one.");
+    return;
+  }
+
+  edges_ = edges;
+  table_.Build(contents);
+}
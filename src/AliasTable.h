@@ -0,0 +1,84 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | AliasTable.h
+//
+//  Walker's alias method for sampling a discrete distribution in constant
+//  time, independently of the number of outcomes. Combined with a set of
+//  bin edges, it samples piecewise-uniform (histogram) distributions.
+// -----------------------------------------------------------------------------
+
+#ifndef ALIAS_TABLE_H
+#define ALIAS_TABLE_H
+
+#include <G4Types.hh>
+
+#include <vector>
+#include <cstddef>
+
+
+class AliasTable
+{
+public:
+  AliasTable();
+  // Build the table for the given (not necessarily normalized) weights
+  explicit AliasTable(const std::vector<G4double>& weights);
+  ~AliasTable();
+
+  void Build(const std::vector<G4double>& weights);
+
+  std::size_t GetSize() const;
+
+  // Index of an outcome from a single uniform random number in [0,1)
+  std::size_t Sample(G4double u) const;
+
+private:
+  std::vector<G4double> threshold_;
+  std::vector<std::size_t> alias_;
+};
+
+
+// Histogram distribution sampled with an alias table. Bins may have
+// different widths; the value is uniform within the bin.
+class AliasHistogram
+{
+public:
+  AliasHistogram();
+  ~AliasHistogram();
+
+  // edges has one more element than contents; contents are the bin
+  // integrals (i.e. probabilities), not densities.
+  void Build(const std::vector<G4double>& edges,
+             const std::vector<G4double>& contents);
+
+  G4double GetMin() const;
+  G4double GetMax() const;
+
+  // Sample a value from two uniform random numbers in [0,1)
+  G4double Sample(G4double u1, G4double u2) const;
+
+private:
+  std::vector<G4double> edges_;
+  AliasTable table_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+inline std::size_t AliasTable::GetSize() const { return threshold_.size(); }
+
+inline std::size_t AliasTable::Sample(G4double u) const
+{
+  const G4double x = u * threshold_.size();
+  std::size_t i = static_cast<std::size_t>(x);
+  if (i >= threshold_.size()) i = threshold_.size() - 1;
+  return (x - i < threshold_[i]) ? i : alias_[i];
+}
+
+inline G4double AliasHistogram::GetMin() const { return edges_.front(); }
+inline G4double AliasHistogram::GetMax() const { return edges_.back(); }
+
+inline G4double AliasHistogram::Sample(G4double u1, G4double u2) const
+{
+  const std::size_t i = table_.Sample(u1);
+  return edges_[i] + u2 * (edges_[i+1] - edges_[i]);
+}
+
+#endif
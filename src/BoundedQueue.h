@@ -0,0 +1,112 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | BoundedQueue.h
+//
+//  Fixed-capacity, thread-safe FIFO queue for passing work items from
+//  producer threads (e.g. Geant4 workers) to a consumer thread.
+// -----------------------------------------------------------------------------
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <utility>
+
+
+template <typename T>
+class BoundedQueue
+{
+public:
+  explicit BoundedQueue(std::size_t capacity);
+
+  // Push an item, waiting while the queue is full. Returns false
+  // (and discards the item) if the queue has been closed.
+  bool Push(T&& item);
+
+  // Pop the oldest item, waiting while the queue is empty. Returns false
+  // once the queue has been closed and all items have been consumed.
+  bool Pop(T& item);
+
+  // Wake up all waiting threads; no more items are accepted afterwards.
+  void Close();
+  // Make the queue usable again after Close().
+  void Reopen(std::size_t capacity);
+
+  std::size_t Size() const;
+
+private:
+  std::size_t capacity_;
+  bool closed_;
+  std::deque<T> items_;
+  mutable std::mutex mutex_;
+  std::condition_variable not_full_, not_empty_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+template <typename T>
+BoundedQueue<T>::BoundedQueue(std::size_t capacity):
+  capacity_(capacity > 0 ? capacity : 1), closed_(false)
+{
+}
+
+
+template <typename T>
+bool BoundedQueue<T>::Push(T&& item)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_full_.wait(lock, [this]{ return closed_ || items_.size() < capacity_; });
+  if (closed_) return false;
+  items_.push_back(std::move(item));
+  lock.unlock();
+  not_empty_.notify_one();
+  return true;
+}
+
+
+template <typename T>
+bool BoundedQueue<T>::Pop(T& item)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_empty_.wait(lock, [this]{ return closed_ || !items_.empty(); });
+  if (items_.empty()) return false;
+  item = std::move(items_.front());
+  items_.pop_front();
+  lock.unlock();
+  not_full_.notify_one();
+  return true;
+}
+
+
+template <typename T>
+void BoundedQueue<T>::Close()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  not_full_.notify_all();
+  not_empty_.notify_all();
+}
+
+
+template <typename T>
+void BoundedQueue<T>::Reopen(std::size_t capacity)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = capacity > 0 ? capacity : 1;
+  closed_ = false;
+  items_.clear();
+}
+
+
+template <typename T>
+std::size_t BoundedQueue<T>::Size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return items_.size();
+}
+
+#endif
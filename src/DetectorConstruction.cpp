@@ -11,12 +11,14 @@
 #include "Materials.h"
 #include "OpticalMaterialProperties.h"
 #include "OpticalSD.h"
+#include "SensorArrayParameterisation.h"
 
 #include <G4Box.hh>
 #include <G4Tubs.hh>
 #include <G4Sphere.hh>
 #include <G4LogicalVolume.hh>
 #include <G4PVPlacement.hh>
+#include <G4PVParameterised.hh>
 #include <G4SystemOfUnits.hh>
 #include <G4PhysicalConstants.hh>
 #include <G4NistManager.hh>
@@ -27,6 +29,14 @@
 #include <G4OpticalSurface.hh>
 #include <G4LogicalSkinSurface.hh>
 #include <G4LogicalBorderSurface.hh>
+#include <G4SurfaceProperty.hh>
+#include <G4GenericMessenger.hh>
+#include <G4RunManager.hh>
+#include <G4StateManager.hh>
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
 
 
 DetectorConstruction::DetectorConstruction():
@@ -36,18 +46,144 @@ DetectorConstruction::DetectorConstruction():
   plate_thickn_(  4.0*mm), // Y
   plate_length_(491.5*mm), // Z
   foil_thickn_(0.165*mm),
-  num_phsensors(48)
+  sensor_standoff_(1.*mm),
+  unit_efficiencies_(false),
+  sensors_per_side_(24),
+  sensor_pitch_(0.),
+  sensor_sides_("both"),
+  envelope_(false),
+  envelope_margin_(1.*cm),
+  escape_model_("track"),
+  escape_albedo_(0.),
+  num_cells_{1, 1},
+  cell_pitch_{0., 0.},
+  msg_(nullptr)
 {
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/geometry/",
+                                "Control of the detector geometry.");
+
+  // The geometry is built by the master thread only.
+  msg_->DeclareMethod("sensorsPerSide", &DetectorConstruction::SetSensorsPerSide,
+                      "Number of photosensors along each side of the plate.")
+    .SetParameterName("n", false)
+    .SetRange("n>0")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethodWithUnit("sensorPitch", "mm", &DetectorConstruction::SetSensorPitch,
+                              "Distance between photosensor centres "
+                              "(0 spreads them evenly over the plate length).")
+    .SetParameterName("pitch", false)
+    .SetRange("pitch>=0.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethod("sensorSides", &DetectorConstruction::SetSensorSides,
+                      "Sides of the plate instrumented with photosensors.")
+    .SetParameterName("sides", false)
+    .SetCandidates("both left right")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethodWithUnit("plateWidth", "mm", &DetectorConstruction::SetPlateWidth,
+                              "Size of the WLS plate along x.")
+    .SetParameterName("width", false)
+    .SetRange("width>0.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethodWithUnit("plateThickness", "mm", &DetectorConstruction::SetPlateThickness,
+                              "Size of the WLS plate along y.")
+    .SetParameterName("thickness", false)
+    .SetRange("thickness>0.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethodWithUnit("plateLength", "mm", &DetectorConstruction::SetPlateLength,
+                              "Size of the WLS plate along z.")
+    .SetParameterName("length", false)
+    .SetRange("length>0.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethodWithUnit("foilThickness", "mm", &DetectorConstruction::SetFoilThickness,
+                              "Thickness of the reflective foils.")
+    .SetParameterName("thickness", false)
+    .SetRange("thickness>0.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethodWithUnit("sensorStandoff", "mm", &DetectorConstruction::SetSensorStandoff,
+                              "Distance between the plate edges and the centres "
+                              "of the photosensor arrays.")
+    .SetParameterName("standoff", false)
+    .SetRange("standoff>=0.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethod("unitEfficiencies", &DetectorConstruction::SetUnitEfficiencies,
+                      "Set the foil reflectivity and the sensor efficiency to 1 "
+                      "(for photon-path reweighting).")
+    .SetParameterName("enable", false)
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethodWithUnit("worldSize", "m", &DetectorConstruction::SetWorldSize,
+                              "Diameter of the LAr world sphere.")
+    .SetParameterName("size", false)
+    .SetRange("size>0.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethod("envelope", &DetectorConstruction::SetEnvelope,
+                      "Place all components inside a tight LAr envelope.")
+    .SetParameterName("enable", false)
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethodWithUnit("envelopeMargin", "mm", &DetectorConstruction::SetEnvelopeMargin,
+                              "Distance between the components and the envelope walls.")
+    .SetParameterName("margin", false)
+    .SetRange("margin>0.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethod("escapeModel", &DetectorConstruction::SetEscapeModel,
+                      "Fate of the photons leaving the envelope.")
+    .SetParameterName("model", false)
+    .SetCandidates("track kill albedo")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethod("escapeAlbedo", &DetectorConstruction::SetEscapeAlbedo,
+                      "Probability that a photon leaving the envelope is sent "
+                      "back (Lambertian) in the albedo escape model.")
+    .SetParameterName("albedo", false)
+    .SetRange("albedo>=0. && albedo<=1.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethod("numCells", &DetectorConstruction::SetNumCells,
+                      "Number of cells tiled along x and z.")
+    .SetParameterName("n", false)
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethodWithUnit("cellPitchX", "mm", &DetectorConstruction::SetCellPitchX,
+                              "Distance between cell centres along x (0: adjacent cells).")
+    .SetParameterName("pitch", false)
+    .SetRange("pitch>=0.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethodWithUnit("cellPitchZ", "mm", &DetectorConstruction::SetCellPitchZ,
+                              "Distance between cell centres along z (0: adjacent cells).")
+    .SetParameterName("pitch", false)
+    .SetRange("pitch>=0.")
+    .SetToBeBroadcasted(false);
 }
 
 
 DetectorConstruction::~DetectorConstruction()
 {
+  delete msg_;
 }
 
 
 G4VPhysicalVolume* DetectorConstruction::Construct()
 {
+  // The geometry may be rebuilt after a change of configuration.
+  // Volumes are deleted by the run manager, but optical surfaces are not.
+  G4LogicalSkinSurface::CleanSurfaceTable();
+  G4LogicalBorderSurface::CleanSurfaceTable();
+  G4SurfaceProperty::CleanSurfacePropertyTable();
+  // The volumes using them have been deleted (ReinitializeGeometry(true))
+  parameterisations_.clear();
+
   // WORLD ///////////////////////////////////////////////////////////
   // Sphere of liquid argon that contains all other volumes.
 
@@ -69,14 +205,340 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 
   ////////////////////////////////////////////////////////////////////
 
-  ConstructWLSPlate(world_phys_vol);
-  ConstructPhotosensors(world_phys_vol);
-  ConstructReflectiveFoils(world_phys_vol);
+  G4VPhysicalVolume* mother_phys_vol =
+    envelope_ ? ConstructEnvelope(world_phys_vol) : world_phys_vol;
+
+  if (num_cells_[0] * num_cells_[1] > 1)
+    mother_phys_vol = ConstructCells(mother_phys_vol);
+
+  ConstructWLSPlate(mother_phys_vol);
+  ConstructPhotosensors(mother_phys_vol);
+  ConstructReflectiveFoils(mother_phys_vol);
 
   return world_phys_vol;
 }
 
 
+void DetectorConstruction::ConstructSDandField()
+{
+  // Sensitive detectors are thread-local objects: this method is invoked
+  // once per worker thread (and once in sequential mode), while the
+  // geometry built in Construct() is shared among all threads.
+
+  // After a rebuild of the geometry, the detector created for the previous
+  // one is reconfigured and attached to the new volumes.
+  const G4String sdname = "/GENERIC_PHOTOSENSOR/SiPM";
+  G4SDManager* sdmgr = G4SDManager::GetSDMpointer();
+
+  OpticalSD* sensdet =
+    static_cast<OpticalSD*>(sdmgr->FindSensitiveDetector(sdname, false));
+
+  if (!sensdet) {
+    sensdet = new OpticalSD(sdname, GetNumberOfSensors());
+    sdmgr->AddNewDetector(sensdet);
+  }
+
+  // Sensor ID = replica number within the array + array copy number
+  // (one array per side) * sensors per side [+ cell copy number * sensors
+  // per cell when tiled]
+  std::vector<std::pair<G4int, G4int>> id_levels = {{1, 1}, {2, sensors_per_side_}};
+  if (num_cells_[0] * num_cells_[1] > 1) id_levels.push_back({3, GetSensorsPerCell()});
+
+  sensdet->SetNumberOfSensors(GetNumberOfSensors());
+  sensdet->SetSensorIDLevels(id_levels);
+
+  SetSensitiveDetector("PHOTOSENSOR_SENSAREA", sensdet);
+}
+
+
+G4VPhysicalVolume* DetectorConstruction::ConstructEnvelope(G4VPhysicalVolume* world_phys_vol) const
+{
+  // ENVELOPE ////////////////////////////////////////////////////////
+  // Box of the world material enclosing the plate, the photosensor
+  // arrays and the reflective foils of all cells, plus a margin.
+
+  Assert(world_phys_vol, "DetectorConstruction::ConstructEnvelope()");
+
+  const G4String envelope_name = "ENVELOPE";
+
+  // Extent of the whole tiling (a single cell by default) plus the margin
+  const G4ThreeVector half_size =
+    GetTilingHalfSize() + G4ThreeVector(1., 1., 1.) * envelope_margin_;
+
+  CheckInsideWorld(half_size, "DetectorConstruction::ConstructEnvelope()");
+
+  G4Box* envelope_solid_vol =
+    new G4Box(envelope_name, half_size.x(), half_size.y(), half_size.z());
+
+  G4LogicalVolume* envelope_logic_vol =
+    new G4LogicalVolume(envelope_solid_vol,
+                        world_phys_vol->GetLogicalVolume()->GetMaterial(),
+                        envelope_name);
+  envelope_logic_vol->SetVisAttributes(G4VisAttributes::Invisible);
+
+  G4VPhysicalVolume* envelope_phys_vol =
+    new G4PVPlacement(nullptr, G4ThreeVector(),
+                      envelope_logic_vol, envelope_name,
+                      world_phys_vol->GetLogicalVolume(), false, 0, true);
+
+  // Photons crossing the envelope walls outwards hit a painted surface:
+  // they are absorbed (i.e. terminated) or, with probability equal to the
+  // albedo, reflected back diffusely.
+  if (escape_model_ != "track") {
+    const G4double albedo = (escape_model_ == "albedo") ? escape_albedo_ : 0.;
+
+    G4OpticalSurface* escape_opsurf =
+      new G4OpticalSurface("ESCAPE_SURFACE", unified, groundfrontpainted,
+                           dielectric_dielectric);
+    escape_opsurf->SetMaterialPropertiesTable(
+      OpticalMaterialProperties::Albedo(albedo));
+
+    new G4LogicalBorderSurface("ESCAPE_SURFACE", envelope_phys_vol,
+                               world_phys_vol, escape_opsurf);
+  }
+
+  return envelope_phys_vol;
+}
+
+
+G4VPhysicalVolume* DetectorConstruction::ConstructCells(G4VPhysicalVolume* mother_phys_vol) const
+{
+  // CELLS ///////////////////////////////////////////////////////////
+  // Boxes of the mother material, each holding a full set of components,
+  // tiled along x and z around the origin. All cells share the same
+  // logical volume, so the memory footprint does not grow with the number
+  // of cells, and the navigator finds the cell of a point through the
+  // smart voxels of the mother volume.
+
+  Assert(mother_phys_vol, "DetectorConstruction::ConstructCells()");
+
+  const G4String cell_name = "CELL";
+  const G4ThreeVector half_size = GetCellHalfSize();
+  const G4double pitch[2] = {GetCellPitch(0), GetCellPitch(1)};
+
+  // The overlap check of every placement against all the other cells
+  // would scale quadratically; cells are instead kept apart by construction.
+  if (pitch[0] < 2.*half_size.x() || pitch[1] < 2.*half_size.z()) {
+    G4ExceptionDescription ed;
+    ed << "Cell pitch (" << pitch[0]/mm << ", " << pitch[1]/mm
+       << ") mm smaller than cell size (" << 2.*half_size.x()/mm << ", "
+       << 2.*half_size.z()/mm << ") mm.";
+    G4Exception("DetectorConstruction::ConstructCells()", "Geometry",
+                FatalException, ed);
+  }
+
+  // Nor are the cells checked against the world boundary
+  CheckInsideWorld(GetTilingHalfSize(), "DetectorConstruction::ConstructCells()");
+
+  G4Box* cell_solid_vol =
+    new G4Box(cell_name, half_size.x(), half_size.y(), half_size.z());
+
+  G4LogicalVolume* cell_logic_vol =
+    new G4LogicalVolume(cell_solid_vol,
+                        mother_phys_vol->GetLogicalVolume()->GetMaterial(),
+                        cell_name);
+  cell_logic_vol->SetVisAttributes(G4VisAttributes::Invisible);
+
+  // Copy number = ix * nz + iz
+  G4VPhysicalVolume* cell_phys_vol = nullptr;
+
+  for (G4int ix=0; ix<num_cells_[0]; ++ix) {
+    for (G4int iz=0; iz<num_cells_[1]; ++iz) {
+
+      G4ThreeVector pos((ix - 0.5 * (num_cells_[0] - 1)) * pitch[0], 0.,
+                        (iz - 0.5 * (num_cells_[1] - 1)) * pitch[1]);
+
+      G4VPhysicalVolume* pv =
+        new G4PVPlacement(nullptr, pos, cell_logic_vol, cell_name,
+                          mother_phys_vol->GetLogicalVolume(),
+                          false, ix * num_cells_[1] + iz, false);
+
+      if (!cell_phys_vol) cell_phys_vol = pv;
+    }
+  }
+
+  // The components are placed in the logical volume shared by all cells
+  return cell_phys_vol;
+}
+
+
+G4double DetectorConstruction::GetSensorPitch() const
+{
+  return (sensor_pitch_ > 0.) ? sensor_pitch_ : plate_length_ / sensors_per_side_;
+}
+
+
+G4ThreeVector DetectorConstruction::GetCellHalfSize() const
+{
+  GenericPhotosensor photosensor_geom;
+  const G4double half_span =
+    0.5 * (sensors_per_side_ - 1) * GetSensorPitch() + photosensor_geom.GetWidth()/2.;
+
+  return G4ThreeVector(plate_width_/2. + sensor_standoff_ + photosensor_geom.GetThickness(),
+                       std::max(plate_thickn_/2. + 1.*mm + foil_thickn_,
+                                photosensor_geom.GetHeight()/2.),
+                       std::max(plate_length_/2. + 1.*mm + foil_thickn_,
+                                half_span));
+}
+
+
+G4double DetectorConstruction::GetCellPitch(G4int axis) const
+{
+  if (cell_pitch_[axis] > 0.) return cell_pitch_[axis];
+
+  const G4ThreeVector half_size = GetCellHalfSize();
+  return 2. * (axis == 0 ? half_size.x() : half_size.z());
+}
+
+
+G4ThreeVector DetectorConstruction::GetTilingHalfSize() const
+{
+  G4ThreeVector half_size = GetCellHalfSize();
+  half_size.setX(half_size.x() + 0.5 * (num_cells_[0] - 1) * GetCellPitch(0));
+  half_size.setZ(half_size.z() + 0.5 * (num_cells_[1] - 1) * GetCellPitch(1));
+  return half_size;
+}
+
+
+void DetectorConstruction::SetSensorsPerSide(G4int n)
+{
+  sensors_per_side_ = n;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetSensorPitch(G4double pitch)
+{
+  sensor_pitch_ = pitch;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetSensorSides(G4String sides)
+{
+  sensor_sides_ = sides;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetWorldSize(G4double size)
+{
+  world_size_ = size;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetEnvelope(G4bool enable)
+{
+  envelope_ = enable;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetEnvelopeMargin(G4double margin)
+{
+  envelope_margin_ = margin;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetEscapeModel(G4String model)
+{
+  escape_model_ = model;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetEscapeAlbedo(G4double albedo)
+{
+  escape_albedo_ = albedo;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetNumCells(const G4String& value)
+{
+  std::istringstream iss(value);
+  G4int n[2];
+  if (!(iss >> n[0] >> n[1]) || n[0] < 1 || n[1] < 1) {
+    G4ExceptionDescription ed;
+    ed << "Invalid number of cells '" << value << "' (expected nx nz > 0).";
+    G4Exception("DetectorConstruction::SetNumCells()", "Geometry",
+                JustWarning, ed);
+    return;
+  }
+  num_cells_[0] = n[0];
+  num_cells_[1] = n[1];
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetCellPitchX(G4double pitch)
+{
+  cell_pitch_[0] = pitch;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetCellPitchZ(G4double pitch)
+{
+  cell_pitch_[1] = pitch;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetPlateWidth(G4double width)
+{
+  plate_width_ = width;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetPlateThickness(G4double thickness)
+{
+  plate_thickn_ = thickness;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetPlateLength(G4double length)
+{
+  plate_length_ = length;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetFoilThickness(G4double thickness)
+{
+  foil_thickn_ = thickness;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetSensorStandoff(G4double standoff)
+{
+  sensor_standoff_ = standoff;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::SetUnitEfficiencies(G4bool enable)
+{
+  unit_efficiencies_ = enable;
+  ModifyGeometry();
+}
+
+
+void DetectorConstruction::ModifyGeometry()
+{
+  // Nothing to do if the geometry has not been built yet
+  if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_PreInit)
+    return;
+
+  G4RunManager::GetRunManager()->ReinitializeGeometry(true);
+}
+
+
 void DetectorConstruction::ConstructWLSPlate(G4VPhysicalVolume* world_phys_vol) const
 {
   // WLS PLATE ///////////////////////////////////////////////////////
@@ -100,11 +562,12 @@ void DetectorConstruction::ConstructWLSPlate(G4VPhysicalVolume* world_phys_vol)
 }
 
 
-void DetectorConstruction::ConstructPhotosensors(G4VPhysicalVolume* world_phys_vol) const
+void DetectorConstruction::ConstructPhotosensors(G4VPhysicalVolume* world_phys_vol)
 {
   Assert(world_phys_vol, "DetectorConstruction::ConstructPhotosensors()");
 
   GenericPhotosensor photosensor_geom;
+  photosensor_geom.SetUnitEfficiency(unit_efficiencies_);
   photosensor_geom.Construct();
   G4LogicalVolume* photosensor_logic_vol = photosensor_geom.GetLogicalVolume();
 
@@ -113,40 +576,84 @@ void DetectorConstruction::ConstructPhotosensors(G4VPhysicalVolume* world_phys_v
                 FatalException, "    Description : Null pointer to logical volume.");
   }
 
-  G4int phsensor_id = 0;
+  // Each instrumented side of the plate holds a row of sensors along z,
+  // placed as a single parameterised volume inside a LAr container box
+  // that hugs the sensors. The container copy number identifies the side,
+  // the replica number the sensor within the row.
 
-  G4RotationMatrix* rot = new G4RotationMatrix();
-  rot->rotateY(-90*deg);
+  const G4double pitch = GetSensorPitch();
 
-  for (G4int i=0; i<num_phsensors/2; ++i) {
+  const G4double half_span = 0.5 * (sensors_per_side_ - 1) * pitch;
 
-    phsensor_id = i;
-
-    G4ThreeVector pos(-plate_width_/2. - 1.*mm,
-                      0.,
-                      -plate_length_/2. + (0.5 + i) * plate_length_/(num_phsensors/2));
+  if (pitch < photosensor_geom.GetWidth()) {
+    G4ExceptionDescription ed;
+    ed << "Photosensor pitch (" << pitch/mm << " mm) smaller than "
+       << "photosensor width (" << photosensor_geom.GetWidth()/mm << " mm).";
+    G4Exception("DetectorConstruction::ConstructPhotosensors()", "Geometry",
+                FatalException, ed);
+  }
 
-    new G4PVPlacement(rot, pos,
-                      photosensor_logic_vol, photosensor_logic_vol->GetName(),
-                      world_phys_vol->GetLogicalVolume(),
-                      false, phsensor_id, true);
+  // The arrays would overlap the plate: overlap checking only warns
+  if (sensor_standoff_ < photosensor_geom.GetThickness()/2.) {
+    G4ExceptionDescription ed;
+    ed << "Photosensor standoff (" << sensor_standoff_/mm << " mm) smaller than "
+       << "half the photosensor thickness (" << photosensor_geom.GetThickness()/2./mm
+       << " mm).";
+    G4Exception("DetectorConstruction::ConstructPhotosensors()", "Geometry",
+                FatalException, ed);
   }
 
-  G4RotationMatrix* rot2 = new G4RotationMatrix();
-  rot2->rotateY(90*deg);
+  const G4String array_name = "SENSOR_ARRAY";
+
+  G4Box* array_solid_vol =
+    new G4Box(array_name, photosensor_geom.GetThickness()/2.,
+              photosensor_geom.GetHeight()/2.,
+              half_span + photosensor_geom.GetWidth()/2.);
+
+  G4LogicalVolume* array_logic_vol =
+    new G4LogicalVolume(array_solid_vol,
+                        world_phys_vol->GetLogicalVolume()->GetMaterial(),
+                        array_name);
+  array_logic_vol->SetVisAttributes(G4VisAttributes::Invisible);
+
+  // Sensors face the plate: left side (-x) first, then right side (+x)
+  const G4double sign[2] = {-1., +1.};
+  G4int array_id = 0;
 
-  for (G4int i=0; i<num_phsensors/2; ++i) {
+  for (G4int side=0; side<2; ++side) {
 
-    phsensor_id = i;
+    if (sensor_sides_ == (side == 0 ? "right" : "left")) continue;
 
-    G4ThreeVector pos(+plate_width_/2. + 1.*mm,
-                      0.,
-                      -plate_length_/2. + (0.5 + i) * plate_length_/(num_phsensors/2));
+    G4RotationMatrix* rot = new G4RotationMatrix();
+    rot->rotateY(sign[side] * 90.*deg);
 
-    new G4PVPlacement(rot2, pos,
-                      photosensor_logic_vol, photosensor_logic_vol->GetName(),
+    G4LogicalVolume* side_logic_vol = array_logic_vol;
+
+    // A parameterised volume must be the only daughter of its mother,
+    // hence one container logical volume per side.
+    if (array_id > 0) {
+      side_logic_vol = new G4LogicalVolume(array_solid_vol,
+                                           array_logic_vol->GetMaterial(),
+                                           array_name);
+      side_logic_vol->SetVisAttributes(G4VisAttributes::Invisible);
+    }
+
+    parameterisations_.emplace_back(
+      new SensorArrayParameterisation(sensors_per_side_, pitch, rot));
+
+    new G4PVParameterised(photosensor_logic_vol->GetName(),
+                          photosensor_logic_vol, side_logic_vol,
+                          kZAxis, sensors_per_side_,
+                          parameterisations_.back().get());
+
+    G4ThreeVector pos(sign[side] * (plate_width_/2. + sensor_standoff_), 0., 0.);
+
+    new G4PVPlacement(nullptr, pos,
+                      side_logic_vol, array_name,
                       world_phys_vol->GetLogicalVolume(),
-                      false, phsensor_id, true);
+                      false, array_id, true);
+
+    ++array_id;
   }
 
   // //////////////////////////////////////////////////////////
@@ -249,7 +756,9 @@ void DetectorConstruction::ConstructReflectiveFoils(G4VPhysicalVolume* world_phy
   G4OpticalSurface* refsurf_opsurf = 
     new G4OpticalSurface(refsurf_name, unified, polishedfrontpainted, dielectric_dielectric, 1);
   
-  refsurf_opsurf->SetMaterialPropertiesTable(OpticalMaterialProperties::VIKUITI());
+  refsurf_opsurf->SetMaterialPropertiesTable(unit_efficiencies_ ?
+                                             OpticalMaterialProperties::Albedo(1.) :
+                                             OpticalMaterialProperties::VIKUITI());
   new G4LogicalSkinSurface("REF_FOIL_SURFACE",bottom_foil_logic_vol,refsurf_opsurf);
   new G4LogicalSkinSurface("REF_FOIL_SURFACE",side_foil_logic_vol,refsurf_opsurf);
 }
@@ -258,12 +767,26 @@ void DetectorConstruction::Assert(G4VPhysicalVolume* ptr, const G4String& origin
 {
   if (!ptr) {
     G4ExceptionDescription ed;
-    ed << "    Description : World physical volume is not defined.";
+    ed << "    Description : Mother physical volume is not defined.";
     G4Exception(origin, "nullptr", FatalException, ed);
   }
 }
 
 
+void DetectorConstruction::CheckInsideWorld(const G4ThreeVector& half_size,
+                                            const G4String& origin) const
+{
+  // The farthest point of the box is one of its corners
+  if (half_size.mag() <= world_size_/2.) return;
+
+  G4ExceptionDescription ed;
+  ed << "Box of half size (" << half_size.x()/mm << ", " << half_size.y()/mm
+     << ", " << half_size.z()/mm << ") mm does not fit in the world sphere of "
+     << world_size_/m << " m diameter (/G4OpSim/geometry/worldSize).";
+  G4Exception(origin, "Geometry", FatalException, ed);
+}
+
+
 
 
   // // REFLECTIVE FOIL /////////////////////////////////////////////
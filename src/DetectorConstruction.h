@@ -9,9 +9,15 @@
 #define DETECTOR_CONSTRUCTION_H
 
 #include <G4VUserDetectorConstruction.hh>
+#include <G4ThreeVector.hh>
+
+#include <memory>
+#include <vector>
 
 class G4Material;
 class G4LogicalVolume;
+class G4GenericMessenger;
+class G4VPVParameterisation;
 
 
 class DetectorConstruction: public G4VUserDetectorConstruction
@@ -20,19 +26,93 @@ public:
   DetectorConstruction();
   ~DetectorConstruction();
   G4VPhysicalVolume* Construct() override;
+  void ConstructSDandField() override;
+
+  // Number of photosensors in one cell (all sides) and in the detector
+  G4int GetSensorsPerCell() const;
+  G4int GetNumberOfSensors() const;
+
 private:
+  void SetSensorsPerSide(G4int);
+  void SetSensorPitch(G4double);
+  void SetSensorSides(G4String);
+  void SetWorldSize(G4double);
+  void SetEnvelope(G4bool);
+  void SetEnvelopeMargin(G4double);
+  void SetEscapeModel(G4String);
+  void SetEscapeAlbedo(G4double);
+  void SetNumCells(const G4String&);
+  void SetCellPitchX(G4double);
+  void SetCellPitchZ(G4double);
+  void SetPlateWidth(G4double);
+  void SetPlateThickness(G4double);
+  void SetPlateLength(G4double);
+  void SetFoilThickness(G4double);
+  void SetSensorStandoff(G4double);
+  void SetUnitEfficiencies(G4bool);
+  void ModifyGeometry();
+
+
   void ConstructWorld(G4VPhysicalVolume&);
+  G4VPhysicalVolume* ConstructEnvelope(G4VPhysicalVolume*) const;
+  G4VPhysicalVolume* ConstructCells(G4VPhysicalVolume*) const;
   void ConstructWLSPlate(G4VPhysicalVolume*) const;
-  void ConstructPhotosensors(G4VPhysicalVolume*) const;
+  void ConstructPhotosensors(G4VPhysicalVolume*);
   void ConstructReflectiveFoils(G4VPhysicalVolume*) const;
 
   void Assert(G4VPhysicalVolume*, const G4String&) const;
+  // Fatal exception if a box centred at the origin sticks out of the world
+  void CheckInsideWorld(const G4ThreeVector& half_size, const G4String&) const;
+
+  // Distance between the centres of adjacent photosensors
+  G4double GetSensorPitch() const;
+  // Half size of the box enclosing all the components of a cell
+  G4ThreeVector GetCellHalfSize() const;
+  // Distance between the centres of adjacent cells along x (0) and z (1)
+  G4double GetCellPitch(G4int axis) const;
+  // Half size of the box enclosing all the cells
+  G4ThreeVector GetTilingHalfSize() const;
 
 private:
-  const G4double world_size_;
-  const G4double plate_width_, plate_thickn_, plate_length_;
-  const G4double foil_thickn_;
-  const G4int num_phsensors;
+  G4double world_size_;
+  G4double plate_width_, plate_thickn_, plate_length_;
+  G4double foil_thickn_;
+  G4double sensor_standoff_; // plate edge to sensor array centre
+
+  // Foil reflectivity and sensor efficiency set to 1 at all wavelengths,
+  // so that they can be applied afterwards to the photon path records
+  G4bool unit_efficiencies_;
+
+  G4int sensors_per_side_;
+  G4double sensor_pitch_; // 0 means spread evenly over the plate length
+  G4String sensor_sides_; // both, left or right
+
+  // Box of LAr tightly enclosing the plate, foils and sensors, so that
+  // photons escaping it can be terminated (escape model "kill") or sent
+  // back with a Lambertian albedo ("albedo") instead of being tracked
+  // through the world ("track").
+  G4bool envelope_;
+  G4double envelope_margin_;
+  G4String escape_model_;
+  G4double escape_albedo_;
+
+  // Cells (plate, foils and sensors) tiled along x and z. A single cell is
+  // built directly in the mother volume; otherwise the components are
+  // placed in a CELL logical volume that is placed once per tile.
+  G4int num_cells_[2];
+  G4double cell_pitch_[2]; // 0 means adjacent cells
+
+  // Parameterisations of the current geometry (G4PVParameterised does not
+  // own them), released when the geometry is rebuilt
+  std::vector<std::unique_ptr<G4VPVParameterisation>> parameterisations_;
+
+  G4GenericMessenger* msg_;
 };
 
+inline G4int DetectorConstruction::GetSensorsPerCell() const
+{ return (sensor_sides_ == "both" ? 2 : 1) * sensors_per_side_; }
+
+inline G4int DetectorConstruction::GetNumberOfSensors() const
+{ return GetSensorsPerCell() * num_cells_[0] * num_cells_[1]; }
+
 #endif
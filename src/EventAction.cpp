@@ -5,14 +5,75 @@
 // -----------------------------------------------------------------------------
 
 #include "EventAction.h"
+#include "EventRecord.h"
+#include "OpticalHit.h"
+#include "RootOutput.h"
+#include "FlatHitOutput.h"
+#include "PrimaryGeneration.h"
+#include "VisibilityBuilder.h"
+#include "SensorCounts.h"
 
-#include <G4Run.hh>
+#include <G4Event.hh>
+#include <G4HCofThisEvent.hh>
+#include <G4SDManager.hh>
 
 
-void EventAction::BeginOfEventAction(const G4Event*)
+void EventAction::BeginOfEventAction(const G4Event* event)
 {
+  // In fast mode no photon is tracked: the detections sampled by the
+  // generator from the visibility library are added to the hits here
+  // (the hits collection has already been created by the SD).
+  if (!generator_ || generator_->GetDetections().empty()) return;
+
+  G4HCofThisEvent* hce = event->GetHCofThisEvent();
+  if (!hce) return;
+
+  if (hcid_ < 0)
+    hcid_ = G4SDManager::GetSDMpointer()->GetCollectionID("SiPM/Optical");
+
+  OpticalHitCollection* hc = static_cast<OpticalHitCollection*>(hce->GetHC(hcid_));
+  if (!hc) return;
+
+  // The library has as many sensors as the hits collection (checked by
+  // PrimaryGeneration::BeginOfRun())
+  for (const PrimaryGeneration::Detection& det: generator_->GetDetections()) {
+    OpticalHit* hit = (*hc)[det.sensor_id];
+    hit->Fill(det.time);
+    // The library does not store wavelengths: recorded as 0
+    if (hit->GetRecordPhotons()) hit->AddPhoton(det.time, 0.);
+  }
 }
 
-void EventAction::EndOfEventAction(const G4Event*)
+void EventAction::EndOfEventAction(const G4Event* event)
 {
+  RootOutput& root_output = RootOutput::Instance();
+  FlatHitOutput& flat_output = FlatHitOutput::Instance();
+  const G4int scan_voxel = generator_ ? generator_->GetScanVoxel() : -1;
+  if (!root_output.IsOpen() && !flat_output.IsOpen() && scan_voxel < 0 &&
+      !sensor_counts_) return;
+
+  G4HCofThisEvent* hce = event->GetHCofThisEvent();
+  if (!hce) return;
+
+  if (hcid_ < 0)
+    hcid_ = G4SDManager::GetSDMpointer()->GetCollectionID("SiPM/Optical");
+
+  const OpticalHitCollection* hc =
+    static_cast<const OpticalHitCollection*>(hce->GetHC(hcid_));
+  if (!hc) return;
+
+  if (sensor_counts_) sensor_counts_->Add(*hc);
+
+  if (scan_voxel >= 0)
+    VisibilityBuilder::Instance().Add(scan_voxel, generator_->GetNumEmitted(), *hc);
+
+  if (root_output.IsOpen()) {
+    // The record is built here, in the worker thread, but serialized
+    // and written to disk by the output writer thread.
+    EventRecord record;
+    record.Fill(event->GetEventID(), *hc);
+    root_output.Write(std::move(record));
+  }
+
+  flat_output.Write(event->GetEventID(), *hc);
 }
@@ -8,20 +8,34 @@
 #define EVENT_ACTION_H
 
 #include <G4UserEventAction.hh>
+#include <globals.hh>
 
 class G4Event;
+class PrimaryGeneration;
+class SensorCounts;
 
 
 class EventAction: public G4UserEventAction
 {
 public:
-  EventAction();
+  // The primary generator provides the detections sampled in fast mode
+  // and the voxel scanned in the visibility-library scan mode. The
+  // detections of every event are added to the sensor counts (if given).
+  EventAction(PrimaryGeneration* generator=nullptr,
+              SensorCounts* sensor_counts=nullptr);
   virtual ~EventAction();
   virtual void BeginOfEventAction(const G4Event*);
   virtual void EndOfEventAction(const G4Event*);
+
+private:
+  G4int hcid_; // ID of the optical hits collection
+  PrimaryGeneration* generator_;
+  SensorCounts* sensor_counts_;
 };
 
-inline EventAction::EventAction() {}
+inline EventAction::EventAction(PrimaryGeneration* generator,
+                                SensorCounts* sensor_counts):
+  hcid_(-1), generator_(generator), sensor_counts_(sensor_counts) {}
 inline EventAction::~EventAction() {}
 
 #endif
@@ -0,0 +1,43 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | EventRecord.cpp
+//
+//  Flat, column-oriented summary of the optical hits of an event.
+// -----------------------------------------------------------------------------
+
+#include "EventRecord.h"
+
+#include <G4SystemOfUnits.hh>
+
+
+EventRecord::EventRecord(): event_id(-1)
+{
+}
+
+
+void EventRecord::Fill(G4int id, const OpticalHitCollection& hc)
+{
+  event_id = id;
+
+  sensor_id.clear();
+  sensor_counts.clear();
+  wvf_sensor_id.clear();
+  wvf_time.clear();
+  wvf_counts.clear();
+
+  for (size_t i=0; i<hc.entries(); ++i) {
+    const OpticalHit* hit = hc[i];
+    const Waveform& wvf = hit->GetWaveform();
+    if (wvf.empty()) continue;
+
+    G4int total = 0;
+    for (const auto& bin: wvf) {
+      wvf_sensor_id.push_back(hit->GetSensorID());
+      wvf_time.push_back(static_cast<G4float>(bin.first/ns));
+      wvf_counts.push_back(bin.second);
+      total += bin.second;
+    }
+
+    sensor_id.push_back(hit->GetSensorID());
+    sensor_counts.push_back(total);
+  }
+}
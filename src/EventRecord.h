@@ -0,0 +1,33 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | EventRecord.h
+//
+//  Flat, column-oriented summary of the optical hits of an event, built by
+//  the worker threads and handed over to the output writers.
+// -----------------------------------------------------------------------------
+
+#ifndef EVENT_RECORD_H
+#define EVENT_RECORD_H
+
+#include "OpticalHit.h"
+
+#include <vector>
+
+
+struct EventRecord
+{
+  G4int event_id;
+
+  // Photon counts of the sensors with at least one detection
+  std::vector<G4int> sensor_id;
+  std::vector<G4int> sensor_counts;
+
+  // Non-empty waveform bins of those sensors, flattened
+  std::vector<G4int>   wvf_sensor_id;
+  std::vector<G4float> wvf_time; // bin low edge, in ns
+  std::vector<G4int>   wvf_counts;
+
+  EventRecord();
+  void Fill(G4int event_id, const OpticalHitCollection&);
+};
+
+#endif
@@ -0,0 +1,86 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | FlatHitFormat.h
+//
+//  Layout of the flat binary hit files: an append-only sequence of blocks,
+//  each holding a fixed number of photon-hit records stored column by
+//  column, followed by an index of the blocks. All values are little-endian.
+//
+//    header   FileHeader
+//    block 0  event_id[n0] | sensor_id[n0] | time[n0] | wavelength[n0]
+//    block 1  ...
+//    index    BlockIndexEntry[num_blocks]
+//    trailer  FileTrailer
+//
+//  Every column starts at an offset aligned to kColumnAlignment bytes, so
+//  that a memory-mapped file can be accessed through plain typed pointers.
+//  This header does not depend on Geant4 so that it can be shared with the
+//  reader library.
+// -----------------------------------------------------------------------------
+
+#ifndef FLAT_HIT_FORMAT_H
+#define FLAT_HIT_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+
+
+namespace FlatHitFormat {
+
+  const char kHeaderMagic[8]  = {'G','4','O','S','H','I','T','S'};
+  const char kTrailerMagic[8] = {'G','4','O','S','H','E','N','D'};
+
+  const std::uint32_t kVersion = 1;
+
+  // The files are written and read as they are laid out in memory (no byte
+  // swapping), so only little-endian hosts can write or read them. The
+  // writer and the readers assert it at compile time.
+  const bool kHostIsLittleEndian = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+  const std::size_t kColumnAlignment = 64;
+
+  // Columns of a block, in storage order
+  enum Column { kEventID = 0, kSensorID, kTime, kWavelength, kNumColumns };
+
+  // All columns have 4-byte elements:
+  // event_id and sensor_id are int32, time (ns) and wavelength (nm) float32.
+  const std::size_t kElementSize = 4;
+
+  struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_columns;
+  };
+
+  struct BlockIndexEntry {
+    std::uint64_t offset;   // from the beginning of the file
+    std::uint64_t num_rows;
+  };
+
+  struct FileTrailer {
+    std::uint64_t index_offset;
+    std::uint64_t num_blocks;
+    std::uint64_t num_rows;  // total over all blocks
+    char magic[8];
+  };
+
+  inline std::size_t Align(std::size_t n)
+  { return (n + kColumnAlignment - 1) / kColumnAlignment * kColumnAlignment; }
+
+  // Size in bytes of a column of n rows, including padding
+  inline std::size_t ColumnSize(std::size_t n)
+  { return Align(n * kElementSize); }
+
+  // Offset of a column relative to the beginning of its block
+  inline std::size_t ColumnOffset(Column column, std::size_t n)
+  { return column * ColumnSize(n); }
+
+  inline std::size_t BlockSize(std::size_t n)
+  { return kNumColumns * ColumnSize(n); }
+
+  // Blocks start right after the header, padded to the column alignment
+  inline std::size_t FirstBlockOffset()
+  { return Align(sizeof(FileHeader)); }
+
+} // end namespace FlatHitFormat
+
+#endif
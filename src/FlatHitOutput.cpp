@@ -0,0 +1,170 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | FlatHitOutput.cpp
+//
+//  Writer of flat binary hit files.
+// -----------------------------------------------------------------------------
+
+#include "FlatHitOutput.h"
+#include "RunFileName.h"
+
+#include <G4GenericMessenger.hh>
+
+#include <cstring>
+
+
+static_assert(FlatHitFormat::kHostIsLittleEndian,
+              "Flat hit files are little-endian; big-endian hosts are not supported.");
+
+
+FlatHitOutput& FlatHitOutput::Instance()
+{
+  static FlatHitOutput instance;
+  return instance;
+}
+
+
+FlatHitOutput::FlatHitOutput():
+  filename_(""), path_(""), block_size_(1<<20),
+  open_(false), file_(nullptr), offset_(0), num_rows_(0),
+  msg_(nullptr)
+{
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/output/",
+                                "Control of the output.");
+
+  msg_->DeclareProperty("flatFile", filename_,
+                        "Name of the flat binary hit file (empty: no output).")
+    .SetParameterName("filename", true)
+    .SetDefaultValue("")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareProperty("flatBlockSize", block_size_,
+                        "Number of photon records per block of the flat file.")
+    .SetParameterName("rows", false)
+    .SetRange("rows>0")
+    .SetToBeBroadcasted(false);
+}
+
+
+FlatHitOutput::~FlatHitOutput()
+{
+  Close();
+  delete msg_;
+}
+
+
+void FlatHitOutput::Open(G4int run_id)
+{
+  if (open_ || filename_.empty()) return;
+
+  path_ = RunFileName(filename_, run_id);
+  file_ = std::fopen(path_.c_str(), "wb");
+  if (!file_) {
+    G4ExceptionDescription ed;
+    ed << "Cannot open output file " << path_ << ".";
+    G4Exception("FlatHitOutput::Open()", "FlatHitOutput", FatalException, ed);
+    return;
+  }
+
+  FlatHitFormat::FileHeader header;
+  std::memcpy(header.magic, FlatHitFormat::kHeaderMagic, sizeof(header.magic));
+  header.version = FlatHitFormat::kVersion;
+  header.num_columns = FlatHitFormat::kNumColumns;
+
+  offset_ = 0;
+  num_rows_ = 0;
+  WritePadded(&header, sizeof(header));
+
+  event_id_.reserve(block_size_);
+  sensor_id_.reserve(block_size_);
+  time_.reserve(block_size_);
+  wavelength_.reserve(block_size_);
+  index_.clear();
+
+  open_ = true;
+
+  G4cout << "[FlatHitOutput] Writing photon hits to " << path_ << G4endl;
+}
+
+
+void FlatHitOutput::Write(G4int event_id, const OpticalHitCollection& hc)
+{
+  if (!open_) return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  for (size_t i=0; i<hc.entries(); ++i) {
+    const OpticalHit* hit = hc[i];
+    for (const OpticalHit::Photon& photon: hit->GetPhotons()) {
+      event_id_.push_back(event_id);
+      sensor_id_.push_back(hit->GetSensorID());
+      time_.push_back(photon.time);
+      wavelength_.push_back(photon.wavelength);
+      if (event_id_.size() == static_cast<size_t>(block_size_)) WriteBlock();
+    }
+  }
+}
+
+
+void FlatHitOutput::WriteBlock()
+{
+  const size_t n = event_id_.size();
+  if (n == 0) return;
+
+  FlatHitFormat::BlockIndexEntry entry = {offset_, n};
+  index_.push_back(entry);
+
+  WritePadded(event_id_.data(),   n * FlatHitFormat::kElementSize);
+  WritePadded(sensor_id_.data(),  n * FlatHitFormat::kElementSize);
+  WritePadded(time_.data(),       n * FlatHitFormat::kElementSize);
+  WritePadded(wavelength_.data(), n * FlatHitFormat::kElementSize);
+
+  num_rows_ += n;
+
+  event_id_.clear();
+  sensor_id_.clear();
+  time_.clear();
+  wavelength_.clear();
+}
+
+
+void FlatHitOutput::WritePadded(const void* data, std::size_t n)
+{
+  static const char zeros[FlatHitFormat::kColumnAlignment] = {};
+
+  std::fwrite(data, 1, n, file_);
+  const std::size_t padding = FlatHitFormat::Align(n) - n;
+  std::fwrite(zeros, 1, padding, file_);
+
+  offset_ += n + padding;
+}
+
+
+void FlatHitOutput::Close()
+{
+  if (!open_) return;
+
+  WriteBlock();
+
+  FlatHitFormat::FileTrailer trailer;
+  trailer.index_offset = offset_;
+  trailer.num_blocks = index_.size();
+  trailer.num_rows = num_rows_;
+  std::memcpy(trailer.magic, FlatHitFormat::kTrailerMagic, sizeof(trailer.magic));
+
+  std::fwrite(index_.data(), sizeof(FlatHitFormat::BlockIndexEntry),
+              index_.size(), file_);
+  std::fwrite(&trailer, sizeof(trailer), 1, file_);
+
+  if (std::ferror(file_)) {
+    G4ExceptionDescription ed;
+    ed << "Error writing output file " << path_ << ".";
+    G4Exception("FlatHitOutput::Close()", "FlatHitOutput", JustWarning, ed);
+  }
+
+  std::fclose(file_);
+  file_ = nullptr;
+  open_ = false;
+
+  G4cout << "[FlatHitOutput] " << num_rows_ << " photon hits in "
+         << index_.size() << " blocks written to " << path_ << G4endl;
+}
@@ -0,0 +1,73 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | FlatHitOutput.h
+//
+//  Writer of flat binary hit files (see FlatHitFormat.h): one record per
+//  detected photon with event ID, sensor ID, arrival time and wavelength.
+//  Worker threads append the photons of their events to the current block
+//  under a lock; full blocks are written to disk column by column. There is
+//  a single instance shared by all threads; the file is opened and closed by
+//  the master run action.
+// -----------------------------------------------------------------------------
+
+#ifndef FLAT_HIT_OUTPUT_H
+#define FLAT_HIT_OUTPUT_H
+
+#include "OpticalHit.h"
+#include "FlatHitFormat.h"
+
+#include <globals.hh>
+
+#include <vector>
+#include <mutex>
+#include <cstdio>
+
+class G4GenericMessenger;
+
+
+class FlatHitOutput
+{
+public:
+  static FlatHitOutput& Instance();
+
+  // Open the output file of a run (see RunFileName.h). Nothing is done
+  // if no file name has been configured.
+  void Open(G4int run_id);
+  // Write the pending block, the block index and close the file.
+  void Close();
+
+  G4bool IsOpen() const;
+
+  // Append the photons recorded in the hits of an event (thread-safe)
+  void Write(G4int event_id, const OpticalHitCollection&);
+
+private:
+  FlatHitOutput();
+  ~FlatHitOutput();
+  FlatHitOutput(const FlatHitOutput&) = delete;
+  FlatHitOutput& operator=(const FlatHitOutput&) = delete;
+
+  void WriteBlock();
+  void WritePadded(const void* data, std::size_t n);
+
+private:
+  G4String filename_;
+  G4String path_; // file written in the current run
+  G4int block_size_; // rows per block
+
+  G4bool open_;
+  std::FILE* file_;
+  std::uint64_t offset_;
+  std::uint64_t num_rows_;
+
+  std::vector<std::int32_t> event_id_, sensor_id_;
+  std::vector<G4float> time_, wavelength_;
+  std::vector<FlatHitFormat::BlockIndexEntry> index_;
+
+  std::mutex mutex_;
+
+  G4GenericMessenger* msg_;
+};
+
+inline G4bool FlatHitOutput::IsOpen() const { return open_; }
+
+#endif
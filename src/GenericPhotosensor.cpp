@@ -7,9 +7,9 @@
 
 #include "GenericPhotosensor.h"
 #include "OpticalMaterialProperties.h"
+#include "PropertyLoader.h"
 
 #include "Materials.h"
-#include "OpticalSD.h"
 
 #include <G4Box.hh>
 #include <G4LogicalVolume.hh>
@@ -18,13 +18,15 @@
 #include <G4OpticalSurface.hh>
 #include <G4LogicalSkinSurface.hh>
 #include <G4SystemOfUnits.hh>
-#include <G4SDManager.hh>
+
+#include <algorithm>
 
 
 GenericPhotosensor::GenericPhotosensor():
   width_    (6.0*mm),
   height_   (6.0*mm),
   thickness_(2.0*mm),
+  unit_efficiency_(false),
   logvol_(nullptr)
 {
 }
@@ -96,61 +98,32 @@ void GenericPhotosensor::Construct()
 
   name = "PHOTOSENSOR_OPSURF";
 
-  G4double energy[]       = {OpticalMaterialProperties::energy_max, 3.875*eV, 3.836*eV, 3.815*eV, 3.794*eV, 3.773*eV, 
-                            3.752*eV, 3.732*eV, 3.721*eV, 3.687*eV, 3.701*eV, 3.672*eV, 
-                            3.652*eV, 3.672*eV, 3.642*eV, 3.613*eV, 3.623*eV, 3.594*eV, 
-                            3.613*eV, 3.585*eV, 3.563*eV, 3.539*eV, 3.521*eV, 3.503*eV, 
-                            3.485*eV, 3.441*eV, 3.45*eV, 3.415*eV, 3.382*eV, 3.349*eV, 
-                            3.316*eV, 3.284*eV, 3.253*eV, 3.223*eV, 3.185*eV, 3.192*eV, 
-                            3.148*eV, 3.106*eV, 3.064*eV, 3.023*eV, 2.997*eV, 2.965*eV, 
-                            2.902*eV, 2.83*eV, 2.761*eV, 2.696*eV, 2.619*eV, 2.546*eV, 
-                            2.49*eV, 2.446*eV, 2.411*eV, 2.378*eV, 2.345*eV, 2.318*eV, 
-                            2.294*eV, 2.268*eV, 2.238*eV, 2.216*eV, 2.192*eV, 2.171*eV, 
-                            2.15*eV, 2.137*eV, 2.117*eV, 2.098*eV, 2.079*eV, 2.06*eV, 
-                            2.038*eV, 2.02*eV, 2.006*eV, 1.988*eV, 1.971*eV, 1.962*eV, 
-                            1.943*eV, 1.929*eV, 1.913*eV, 1.889*eV, 1.866*eV, 1.846*eV, 
-                            1.826*eV, 1.797*eV, 1.774*eV, 1.754*eV, 1.734*eV, 1.714*eV, 
-                            1.683*eV, 1.66*eV, 1.641*eV, 1.619*eV, 1.602*eV, 1.578*eV, 
-                            1.557*eV, 1.536*eV, 1.515*eV, 1.499*eV, 1.475*eV, 1.454*eV, 
-                            1.436*eV, 1.418*eV, 1.401*eV, 1.382*eV, OpticalMaterialProperties::energy_min};
-
-  G4double reflectivity[] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 
-                            0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 
-                            0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 
-                            0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 
-                            0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 
-                            0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 
-                            0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 
-                            0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 
-                            0.0, 0.0, 0.0, 0.0};
-
-  G4double efficiency[]   = {0.0, 0.026, 0.037, 0.046, 0.055, 0.068, 0.08, 0.09, 0.099, 0.119, 
-                            0.108, 0.13, 0.143, 0.135, 0.154, 0.17, 0.163, 0.182, 0.176, 
-                            0.19, 0.2, 0.209, 0.217, 0.225, 0.234, 0.245, 0.239, 0.256, 
-                            0.267, 0.278, 0.29, 0.302, 0.312, 0.323, 0.335, 0.329, 0.345, 
-                            0.352, 0.36, 0.367, 0.37, 0.377, 0.385, 0.392, 0.398, 0.401, 
-                            0.398, 0.393, 0.387, 0.381, 0.373, 0.365, 0.356, 0.348, 0.341, 
-                            0.333, 0.323, 0.315, 0.308, 0.3, 0.293, 0.289, 0.28, 0.273, 
-                            0.266, 0.259, 0.252, 0.247, 0.241, 0.233, 0.225, 0.219, 0.211, 
-                            0.206, 0.2, 0.191, 0.183, 0.176, 0.169, 0.159, 0.152, 0.145, 
-                            0.139, 0.132, 0.122, 0.114, 0.108, 0.101, 0.096, 0.088, 0.082, 
-                            0.076, 0.071, 0.066, 0.059, 0.053, 0.048, 0.044, 0.039, 0.035, 0.0};
+  // Photon detection efficiency (in %) as a function of wavelength,
+  // extended with zeros up to the limits of the optical energy range
+  PropertyLoader::Spectrum efficiency =
+    PropertyLoader::Load("sipm_pde_vs_wavelength(nm).csv",
+                         PropertyLoader::kWavelength, nm, 0.01);
+  PropertyLoader::PadWithZeros(efficiency,
+                               OpticalMaterialProperties::energy_min,
+                               OpticalMaterialProperties::energy_max);
+
+  if (unit_efficiency_)
+    std::fill(efficiency.values.begin(), efficiency.values.end(), 1.);
 
+  PropertyLoader::Spectrum reflectivity = efficiency;
+  std::fill(reflectivity.values.begin(), reflectivity.values.end(), 0.);
 
   G4MaterialPropertiesTable* photosensor_mpt = new G4MaterialPropertiesTable();
-  photosensor_mpt->AddProperty("REFLECTIVITY", energy, reflectivity, 101);
-  photosensor_mpt->AddProperty("EFFICIENCY",   energy, efficiency,   101);
+  PropertyLoader::AddProperty(photosensor_mpt, "REFLECTIVITY", reflectivity);
+  PropertyLoader::AddProperty(photosensor_mpt, "EFFICIENCY",   efficiency);
 
   G4OpticalSurface* photosensor_opsurf =
     new G4OpticalSurface(name, unified, polished, dielectric_metal);
   photosensor_opsurf->SetMaterialPropertiesTable(photosensor_mpt);
   new G4LogicalSkinSurface(name, sensarea_logic_vol, photosensor_opsurf);
 
-  // SENSITIVE DETECTOR //////////////////////////////////////////////
-
-  OpticalSD* sensdet = new OpticalSD("/GENERIC_PHOTOSENSOR/SiPM");
-  G4SDManager::GetSDMpointer()->AddNewDetector(sensdet);
-  sensarea_logic_vol->SetSensitiveDetector(sensdet);
+  // The sensitive detector is thread-local and, therefore, it is not
+  // attached here but in DetectorConstruction::ConstructSDandField().
 
   ////////////////////////////////////////////////////////////////////
 }
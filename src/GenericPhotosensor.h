@@ -25,8 +25,13 @@ public:
   G4double GetHeight() const;
   G4double GetThickness() const;
 
+  // Detect every photon reaching the sensitive area, whatever its
+  // wavelength (for reweighting afterwards)
+  void SetUnitEfficiency(G4bool);
+
 private:
   G4double width_, height_, thickness_;
+  G4bool unit_efficiency_;
   G4LogicalVolume* logvol_;
 };
 
@@ -34,5 +39,6 @@ inline G4LogicalVolume* GenericPhotosensor::GetLogicalVolume() { return logvol_;
 inline G4double GenericPhotosensor::GetWidth() const { return width_; }
 inline G4double GenericPhotosensor::GetHeight() const { return height_; }
 inline G4double GenericPhotosensor::GetThickness() const { return thickness_; }
+inline void GenericPhotosensor::SetUnitEfficiency(G4bool u) { unit_efficiency_ = u; }
 
 #endif
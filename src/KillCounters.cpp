@@ -0,0 +1,60 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | KillCounters.cpp
+//
+//  Number of optical photons killed early, per category.
+// -----------------------------------------------------------------------------
+
+#include "KillCounters.h"
+
+#include <G4AccumulableManager.hh>
+
+
+KillCounters::KillCounters():
+  photons("KillCounters_photons", 0),
+  undetectable("KillCounters_undetectable", 0),
+  outside("KillCounters_outside", 0),
+  escaped("KillCounters_escaped", 0),
+  steps("KillCounters_steps", 0)
+{
+}
+
+
+KillCounters::~KillCounters()
+{
+}
+
+
+void KillCounters::Register()
+{
+  G4AccumulableManager* manager = G4AccumulableManager::Instance();
+  manager->RegisterAccumulable(photons);
+  manager->RegisterAccumulable(undetectable);
+  manager->RegisterAccumulable(outside);
+  manager->RegisterAccumulable(escaped);
+  manager->RegisterAccumulable(steps);
+}
+
+
+void KillCounters::Print() const
+{
+  const G4long killed = undetectable.GetValue() + outside.GetValue() +
+                        escaped.GetValue();
+
+  G4cout << "Optical photons stacked: " << photons.GetValue()
+         << ", killed early: " << killed << "\n"
+         << "  undetectable energy:          " << undetectable.GetValue() << "\n"
+         << "  created outside kill region:  " << outside.GetValue() << "\n"
+         << "  escaped kill region/envelope: " << escaped.GetValue() << G4endl;
+}
+
+
+void KillCounters::PrintThroughput(G4double wall_time) const
+{
+  const G4long num_photons = photons.GetValue();
+  if (num_photons == 0 || wall_time <= 0.) return;
+
+  G4cout << "Optical-photon steps per photon: "
+         << G4double(steps.GetValue()) / num_photons << "\n"
+         << "Optical photons per second:      "
+         << num_photons / wall_time << G4endl;
+}
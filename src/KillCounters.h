@@ -0,0 +1,36 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | KillCounters.h
+//
+//  Number of optical photons killed early, per category, by the stacking
+//  and stepping actions, and number of optical-photon steps. Counters are
+//  thread-local accumulables merged into the master at the end of the run.
+// -----------------------------------------------------------------------------
+
+#ifndef KILL_COUNTERS_H
+#define KILL_COUNTERS_H
+
+#include <G4Accumulable.hh>
+#include <globals.hh>
+
+
+class KillCounters
+{
+public:
+  KillCounters();
+  ~KillCounters();
+
+  // Register the counters with the accumulable manager of this thread
+  void Register();
+  // Print the (merged) counters
+  void Print() const;
+  // Print steps per photon and photons per second of wall time
+  void PrintThroughput(G4double wall_time) const;
+
+  G4Accumulable<G4long> photons;      // optical photons classified by the stacking action
+  G4Accumulable<G4long> undetectable; // energy outside the sensor band and not WLS-absorbable
+  G4Accumulable<G4long> outside;      // created outside the kill region
+  G4Accumulable<G4long> escaped;      // left the kill region or the envelope
+  G4Accumulable<G4long> steps;        // optical-photon steps
+};
+
+#endif
@@ -0,0 +1,95 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | LArScintillation.cpp
+//
+//  Emission spectrum and time profile of the liquid-argon scintillation.
+// -----------------------------------------------------------------------------
+
+#include "LArScintillation.h"
+
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicalConstants.hh>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+
+LArScintillation::LArScintillation():
+  peak_wavelength_(126.8*nm), fwhm_(7.8*nm),
+  singlet_fraction_(0.3), tau_singlet_(6.*ns), tau_triplet_(1.5*microsecond),
+  modified_(true)
+{
+  Update();
+}
+
+
+LArScintillation::~LArScintillation()
+{
+}
+
+
+void LArScintillation::Update()
+{
+  if (!modified_) return;
+  BuildSpectrum();
+  BuildTimeProfile();
+  modified_ = false;
+}
+
+
+void LArScintillation::BuildSpectrum()
+{
+  // Gaussian in wavelength, tabulated within +-4 sigma. Bin contents
+  // are the exact integrals of the gaussian over each bin.
+
+  const G4int num_bins = 200;
+  const G4double sigma = fwhm_ / (2.*std::sqrt(2.*std::log(2.)));
+  const G4double lmin  = std::max(peak_wavelength_ - 4.*sigma, 1.*nm);
+  const G4double lmax  = peak_wavelength_ + 4.*sigma;
+
+  std::vector<G4double> edges(num_bins+1), contents(num_bins);
+
+  for (G4int i=0; i<=num_bins; ++i)
+    edges[i] = lmin + i * (lmax - lmin) / num_bins;
+
+  auto cdf = [&](G4double l)
+    { return 0.5 * std::erf((l - peak_wavelength_) / (std::sqrt(2.)*sigma)); };
+
+  for (G4int i=0; i<num_bins; ++i)
+    contents[i] = cdf(edges[i+1]) - cdf(edges[i]);
+
+  wavelength_.Build(edges, contents);
+}
+
+
+void LArScintillation::BuildTimeProfile()
+{
+  // Bins are narrow compared to the local decay time: tau_s/20 during the
+  // first 10 singlet lifetimes, tau_t/100 afterwards, up to 10 triplet
+  // lifetimes. Bin contents are the exact integrals of both components.
+
+  std::vector<G4double> edges;
+
+  const G4double fine_end = 10. * tau_singlet_;
+  const G4double end = std::max(10. * tau_triplet_, fine_end);
+
+  for (G4double t=0.; t<fine_end; t+=tau_singlet_/20.) edges.push_back(t);
+  for (G4double t=fine_end; t<end; t+=tau_triplet_/100.) edges.push_back(t);
+  edges.push_back(end);
+
+  auto survival = [&](G4double t)
+    { return singlet_fraction_ * std::exp(-t/tau_singlet_)
+           + (1. - singlet_fraction_) * std::exp(-t/tau_triplet_); };
+
+  std::vector<G4double> contents(edges.size()-1);
+  for (size_t i=0; i<contents.size(); ++i)
+    contents[i] = survival(edges[i]) - survival(edges[i+1]);
+
+  time_.Build(edges, contents);
+}
+
+
+G4double LArScintillation::SampleEnergy(G4double u1, G4double u2) const
+{
+  return h_Planck * c_light / wavelength_.Sample(u1, u2);
+}
@@ -0,0 +1,76 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | LArScintillation.h
+//
+//  Emission spectrum and time profile of the liquid-argon scintillation,
+//  tabulated in alias tables so that every sample costs O(1). The VUV
+//  spectrum is a gaussian in wavelength (126.8 nm peak, 7.8 nm FWHM by
+//  default); the time profile is the sum of the singlet and triplet
+//  exponential components.
+// -----------------------------------------------------------------------------
+
+#ifndef LAR_SCINTILLATION_H
+#define LAR_SCINTILLATION_H
+
+#include "AliasTable.h"
+
+#include <globals.hh>
+
+
+class LArScintillation
+{
+public:
+  LArScintillation();
+  ~LArScintillation();
+
+  void SetPeakWavelength(G4double);
+  void SetFWHM(G4double);
+  void SetSingletFraction(G4double);
+  void SetSingletLifetime(G4double);
+  void SetTripletLifetime(G4double);
+
+  G4double GetSingletFraction() const;
+  G4double GetSingletLifetime() const;
+  G4double GetTripletLifetime() const;
+
+  // Rebuild the tables if any parameter has changed since the last call
+  void Update();
+
+  // Photon energy and emission time from two uniform random numbers each
+  G4double SampleEnergy(G4double u1, G4double u2) const;
+  G4double SampleTime(G4double u1, G4double u2) const;
+
+private:
+  void BuildSpectrum();
+  void BuildTimeProfile();
+
+private:
+  G4double peak_wavelength_, fwhm_;
+  G4double singlet_fraction_, tau_singlet_, tau_triplet_;
+  G4bool modified_;
+
+  AliasHistogram wavelength_;
+  AliasHistogram time_;
+};
+
+inline void LArScintillation::SetPeakWavelength(G4double l)
+{ peak_wavelength_ = l; modified_ = true; }
+inline void LArScintillation::SetFWHM(G4double w)
+{ fwhm_ = w; modified_ = true; }
+inline void LArScintillation::SetSingletFraction(G4double f)
+{ singlet_fraction_ = f; modified_ = true; }
+inline void LArScintillation::SetSingletLifetime(G4double t)
+{ tau_singlet_ = t; modified_ = true; }
+inline void LArScintillation::SetTripletLifetime(G4double t)
+{ tau_triplet_ = t; modified_ = true; }
+
+inline G4double LArScintillation::GetSingletFraction() const
+{ return singlet_fraction_; }
+inline G4double LArScintillation::GetSingletLifetime() const
+{ return tau_singlet_; }
+inline G4double LArScintillation::GetTripletLifetime() const
+{ return tau_triplet_; }
+
+inline G4double LArScintillation::SampleTime(G4double u1, G4double u2) const
+{ return time_.Sample(u1, u2); }
+
+#endif
@@ -8,20 +8,39 @@
 
 #include "OpticalHit.h"
 
+#include <G4SystemOfUnits.hh>
 
-G4Allocator<OpticalHit> OpticalHitAllocator;
+
+G4ThreadLocal G4Allocator<OpticalHit>* OpticalHitAllocator = nullptr;
+
+
+namespace {
+
+  const std::size_t kMaxPooledVectors = 1024;
+  G4ThreadLocal std::vector<std::vector<OpticalHit::Photon>>* photon_pool = nullptr;
+
+} // namespace
 
 
 OpticalHit::OpticalHit():
   G4VHit(),
   sensor_id_(-1),
-  time_bin_width_(0.)
+  wvf_(1.*ns, 10.*microsecond),
+  record_photons_(false)
 {
 }
 
 
 OpticalHit::~OpticalHit()
 {
+  if (photons_.capacity() == 0) return;
+
+  if (!photon_pool) photon_pool = new std::vector<std::vector<Photon>>;
+  if (photon_pool->size() < kMaxPooledVectors) {
+    photons_.clear();
+    photon_pool->push_back(std::vector<Photon>());
+    photon_pool->back().swap(photons_);
+  }
 }
 
 
@@ -34,8 +53,9 @@ OpticalHit::OpticalHit(const OpticalHit& other): G4VHit()
 const OpticalHit& OpticalHit::operator=(const OpticalHit& other)
 {
   sensor_id_      = other.sensor_id_;
-  time_bin_width_ = other.time_bin_width_;
   wvf_            = other.wvf_;
+  record_photons_ = other.record_photons_;
+  photons_        = other.photons_;
 
   return *this;
 }
@@ -49,8 +69,8 @@ G4int OpticalHit::operator==(const OpticalHit& other) const
 
 void OpticalHit::SetTimeBinWidth(G4double bin_size)
 {
-  if (wvf_.size() == 0) {
-    time_bin_width_ = bin_size;
+  if (wvf_.empty()) {
+    wvf_.SetBinning(bin_size, wvf_.GetWindow());
   }
   else {
     G4String msg = "A OpticalHit cannot be rebinned once it has been filled.";
@@ -59,8 +79,25 @@ void OpticalHit::SetTimeBinWidth(G4double bin_size)
 }
 
 
-void OpticalHit::Fill(G4double time, G4int counts)
+void OpticalHit::SetTimeWindow(G4double window)
+{
+  if (wvf_.empty()) {
+    wvf_.SetBinning(wvf_.GetBinWidth(), window);
+  }
+  else {
+    G4String msg = "A OpticalHit cannot be rebinned once it has been filled.";
+    G4Exception("[OpticalHit]", "SetTimeWindow()", JustWarning, msg);
+  }
+}
+
+
+void OpticalHit::AddPhoton(G4double time, G4double wavelength)
 {
-  G4double time_bin = floor(time/time_bin_width_) * time_bin_width_;
-  wvf_[time_bin] += counts;
+  Photon photon = {static_cast<G4float>(time/ns),
+                   static_cast<G4float>(wavelength/nm)};
+  if (photons_.capacity() == 0 && photon_pool && !photon_pool->empty()) {
+    photons_.swap(photon_pool->back());
+    photon_pool->pop_back();
+  }
+  photons_.push_back(photon);
 }
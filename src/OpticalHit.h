@@ -14,6 +14,9 @@
 #include <G4Allocator.hh>
 #include <G4ThreeVector.hh>
 
+#include "Waveform.h"
+
+#include <vector>
 
 
 class OpticalHit: public G4VHit
@@ -35,33 +38,68 @@ public:
   G4double GetTimeBinWidth() const;
   void     SetTimeBinWidth(G4double);
 
+  // Length of the readout window, starting at t=0, whose time bins are
+  // stored in a dense array. Detections outside it are still recorded,
+  // albeit in a slower sparse container.
+  G4double GetTimeWindow() const;
+  void     SetTimeWindow(G4double);
+
   void Fill(G4double time, G4int counts=1);
 
-  const std::map<G4double, G4int>& GetWaveform() const;
+  const Waveform& GetWaveform() const;
+
+  // Individual photons are only recorded on demand (e.g. for the flat
+  // binary output), in addition to the binned waveform.
+  struct Photon {
+    G4float time;       // ns
+    G4float wavelength; // nm
+  };
+
+  G4bool GetRecordPhotons() const;
+  void   SetRecordPhotons(G4bool);
+
+  void AddPhoton(G4double time, G4double wavelength);
+
+  // The photon vectors of destroyed hits are kept, emptied, in a per-thread
+  // pool and reused by the hits of later events.
+  const std::vector<Photon>& GetPhotons() const;
 
 private:
   G4int sensor_id_;
-  G4double time_bin_width_;
-  std::map<G4double, G4int> wvf_;
+  Waveform wvf_;
+  G4bool record_photons_;
+  std::vector<Photon> photons_;
 };
 
 //////////////////////////////////////////////////////////////////////
 
 typedef G4THitsCollection<OpticalHit> OpticalHitCollection;
-extern G4Allocator<OpticalHit> OpticalHitAllocator;
+extern G4ThreadLocal G4Allocator<OpticalHit>* OpticalHitAllocator;
 
 inline void* OpticalHit::operator new(size_t)
-{ return ((void*) OpticalHitAllocator.MallocSingle()); }
+{
+  if (!OpticalHitAllocator) OpticalHitAllocator = new G4Allocator<OpticalHit>;
+  return ((void*) OpticalHitAllocator->MallocSingle());
+}
 
 inline void OpticalHit::operator delete(void* hit)
-{ OpticalHitAllocator.FreeSingle((OpticalHit*) hit); }
+{ OpticalHitAllocator->FreeSingle((OpticalHit*) hit); }
 
 inline G4int OpticalHit::GetSensorID() const { return sensor_id_; }
 inline void  OpticalHit::SetSensorID(G4int id) { sensor_id_ = id; }
 
-inline G4double OpticalHit::GetTimeBinWidth() const { return time_bin_width_; }
+inline G4double OpticalHit::GetTimeBinWidth() const { return wvf_.GetBinWidth(); }
+inline G4double OpticalHit::GetTimeWindow() const { return wvf_.GetWindow(); }
+
+inline void OpticalHit::Fill(G4double time, G4int counts)
+{ wvf_.Fill(time, counts); }
+
+inline const Waveform& OpticalHit::GetWaveform() const { return wvf_; }
+
+inline G4bool OpticalHit::GetRecordPhotons() const { return record_photons_; }
+inline void OpticalHit::SetRecordPhotons(G4bool r) { record_photons_ = r; }
 
-inline const std::map<G4double, G4int>& OpticalHit::GetWaveform() const
-{ return wvf_; }
+inline const std::vector<OpticalHit::Photon>& OpticalHit::GetPhotons() const
+{ return photons_; }
 
 #endif
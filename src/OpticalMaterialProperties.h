@@ -38,6 +38,9 @@ namespace OpticalMaterialProperties {
 
   G4MaterialPropertiesTable* GlassEpoxy();
 
+  // Painted surface with the same reflectivity at all energies
+  G4MaterialPropertiesTable* Albedo(G4double reflectivity);
+
 } // end namespace
 
 #endif
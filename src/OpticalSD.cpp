@@ -8,33 +8,151 @@
 
 #include "OpticalSD.h"
 #include "OpticalHit.h"
+#include "FlatHitOutput.h"
+#include "PathRecordOutput.h"
+#include "PhotonPath.h"
 
 #include <G4SDManager.hh>
+#include <G4HCofThisEvent.hh>
+#include <G4EventManager.hh>
+#include <G4Event.hh>
+#include <G4PrimaryVertex.hh>
+#include <G4Step.hh>
+#include <G4VTouchable.hh>
+#include <G4OpticalPhoton.hh>
+#include <G4GenericMessenger.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicalConstants.hh>
 
 
 
-OpticalSD::OpticalSD(const G4String& sdname):
-  G4VSensitiveDetector(sdname)
+OpticalSD::OpticalSD(const G4String& sdname, G4int num_sensors):
+  G4VSensitiveDetector(sdname),
+  num_sensors_(num_sensors),
+  id_levels_({{1, 1}}),
+  time_bin_width_(1.*ns),
+  time_window_(10.*microsecond),
+  hcid_(-1),
+  hc_(nullptr),
+  record_paths_(false),
+  num_missing_paths_(0),
+  msg_(nullptr)
 {
   collectionName.insert("Optical");
+
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/sensors/",
+                                "Control of the optical sensors.");
+
+  msg_->DeclarePropertyWithUnit("timeBinWidth", "ns", time_bin_width_,
+                                "Width of the time bins of the waveforms.")
+    .SetParameterName("width", false)
+    .SetRange("width>0.");
+
+  msg_->DeclarePropertyWithUnit("timeWindow", "ns", time_window_,
+                                "Readout window stored in dense time bins.")
+    .SetParameterName("window", false)
+    .SetRange("window>=0.");
 }
 
 
 OpticalSD::~OpticalSD()
 {
+  delete msg_;
 }
 
 
 void OpticalSD::Initialize(G4HCofThisEvent* hce)
 {
+  hc_ = new OpticalHitCollection(SensitiveDetectorName, collectionName[0]);
+
+  if (hcid_ < 0) hcid_ = G4SDManager::GetSDMpointer()->GetCollectionID(hc_);
+  hce->AddHitsCollection(hcid_, hc_);
+
+  // One hit per sensor is created up front so that the hit of a given
+  // sensor sits at the position of the collection given by its copy number.
+  // Detections are then recorded without searching the collection or
+  // creating new hits on the fly. The hits come from their G4Allocator and
+  // their waveform arrays and photon vectors from per-thread pools (see
+  // Waveform.h), so none of this allocates once the first events are done.
+  // Individual photons are only kept if some output needs them.
+  const G4bool record_photons = FlatHitOutput::Instance().IsOpen();
+
+  for (G4int i=0; i<num_sensors_; ++i) {
+    OpticalHit* hit = new OpticalHit();
+    hit->SetSensorID(i);
+    hit->SetTimeBinWidth(time_bin_width_);
+    hit->SetTimeWindow(time_window_);
+    hit->SetRecordPhotons(record_photons);
+    hc_->insert(hit);
+  }
+
+  record_paths_ = PathRecordOutput::Instance().IsOpen();
+  paths_.clear();
+  num_missing_paths_ = 0;
 }
 
 
-G4bool OpticalSD::ProcessHits(G4Step* aStep, G4TouchableHistory*)
+G4bool OpticalSD::ProcessHits(G4Step* step, G4TouchableHistory*)
 {
+  if (step->GetTrack()->GetDefinition() != G4OpticalPhoton::Definition())
+    return false;
+
+  // Photons are detected at the surface of the sensitive area (this method
+  // is invoked by the optical boundary process), hence the post-step point.
+  const G4StepPoint* point = step->GetPostStepPoint();
+  const G4VTouchable* touchable = point->GetTouchable();
+
+  G4int sensor_id = 0;
+  for (const auto& level: id_levels_)
+    sensor_id += touchable->GetCopyNumber(level.first) * level.second;
+
+  if (sensor_id < 0 || sensor_id >= num_sensors_) {
+    G4ExceptionDescription ed;
+    ed << "Sensor ID " << sensor_id << " out of range [0,"
+       << num_sensors_ << ").";
+    G4Exception("OpticalSD::ProcessHits()", "OpticalSD", JustWarning, ed);
+    return false;
+  }
+
+  OpticalHit* hit = (*hc_)[sensor_id];
+  hit->Fill(point->GetGlobalTime());
+
+  if (hit->GetRecordPhotons() || record_paths_) {
+    G4double wavelength = h_Planck * c_light / step->GetTrack()->GetTotalEnergy();
+    if (hit->GetRecordPhotons()) hit->AddPhoton(point->GetGlobalTime(), wavelength);
+
+    const PhotonPath* path =
+      dynamic_cast<const PhotonPath*>(step->GetTrack()->GetUserInformation());
+    if (path) {
+      paths_.emplace_back();
+      path->Fill(paths_.back(), sensor_id, wavelength);
+    }
+    else if (record_paths_) {
+      ++num_missing_paths_;
+    }
+  }
+
+  return true;
 }
 
 
 void OpticalSD::EndOfEvent(G4HCofThisEvent*)
 {
+  if (record_paths_) {
+    const G4Event* event = G4EventManager::GetEventManager()->GetConstCurrentEvent();
+    G4long num_emitted = 0;
+    for (G4int i=0; i<event->GetNumberOfPrimaryVertex(); ++i)
+      num_emitted += event->GetPrimaryVertex(i)->GetNumberOfParticle();
+    PathRecordOutput::Instance().Write(event->GetEventID(), num_emitted, paths_,
+                                       num_missing_paths_);
+  }
+
+  if (verboseLevel < 1) return;
+
+  for (G4int i=0; i<num_sensors_; ++i) {
+    const OpticalHit* hit = (*hc_)[i];
+    if (hit->GetWaveform().empty()) continue;
+    G4cout << "Sensor " << hit->GetSensorID() << ": "
+           << hit->GetWaveform().size() << " time bins filled." << G4endl;
+  }
 }
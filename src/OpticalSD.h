@@ -11,20 +11,65 @@
 
 #include <G4VSensitiveDetector.hh>
 #include "OpticalHit.h"
+#include "PathRecordFormat.h"
+
+#include <vector>
+#include <utility>
+
+class G4GenericMessenger;
 
 
 class OpticalSD: public G4VSensitiveDetector
 {
 public:
-  OpticalSD(const G4String&);
+  // The detector records one hit per sensor, indexed by the sensor ID
+  // (from 0 to num_sensors-1). By default, the ID is the copy number of the
+  // mother of the sensitive area.
+  OpticalSD(const G4String&, G4int num_sensors);
   ~OpticalSD();
 
   void Initialize(G4HCofThisEvent*) override;
   G4bool ProcessHits(G4Step*, G4TouchableHistory*) override;
   void EndOfEvent(G4HCofThisEvent*) override;
 
+  G4int GetNumberOfSensors() const;
+  void  SetNumberOfSensors(G4int);
+
+  // The sensor ID is computed as the sum of the copy numbers found at the
+  // given depths of the touchable history times their multipliers
+  // (e.g. replica number + side * sensors per side).
+  void SetSensorIDLevels(const std::vector<std::pair<G4int, G4int>>&);
+
+  G4double GetTimeBinWidth() const;
+  void     SetTimeBinWidth(G4double);
+
+  G4double GetTimeWindow() const;
+  void     SetTimeWindow(G4double);
+
 private:
+  G4int num_sensors_;
+  std::vector<std::pair<G4int, G4int>> id_levels_; // (depth, multiplier)
+  G4double time_bin_width_;
+  G4double time_window_;
+  G4int hcid_;
   OpticalHitCollection* hc_;
+  // Paths of the photons detected in the event, if recorded
+  G4bool record_paths_;
+  std::vector<PathRecordFormat::Record> paths_;
+  G4int num_missing_paths_; // detected photons without a path
+  G4GenericMessenger* msg_;
 };
 
+inline G4int OpticalSD::GetNumberOfSensors() const { return num_sensors_; }
+inline void OpticalSD::SetNumberOfSensors(G4int n) { num_sensors_ = n; }
+
+inline void OpticalSD::SetSensorIDLevels(const std::vector<std::pair<G4int, G4int>>& l)
+{ id_levels_ = l; }
+
+inline G4double OpticalSD::GetTimeBinWidth() const { return time_bin_width_; }
+inline void OpticalSD::SetTimeBinWidth(G4double w) { time_bin_width_ = w; }
+
+inline G4double OpticalSD::GetTimeWindow() const { return time_window_; }
+inline void OpticalSD::SetTimeWindow(G4double w) { time_window_ = w; }
+
 #endif
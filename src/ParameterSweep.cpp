@@ -0,0 +1,223 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | ParameterSweep.cpp
+//
+//  In-process parameter sweep.
+// -----------------------------------------------------------------------------
+
+#include "ParameterSweep.h"
+#include "RunSummary.h"
+#include "SimulationServer.h"
+
+#include <G4RunManager.hh>
+#include <G4UImanager.hh>
+#include <G4GenericMessenger.hh>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+
+namespace {
+
+  G4String Trim(const G4String& s)
+  {
+    const size_t first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    const size_t last = s.find_last_not_of(" \t\r");
+    return s.substr(first, last - first + 1);
+  }
+
+  G4String Quote(const G4String& s)
+  {
+    G4String quoted = "\"";
+    for (char c: s) {
+      if (c == '"' || c == '\\') quoted += '\\';
+      quoted += c;
+    }
+    return quoted + "\"";
+  }
+
+  // hits.flat -> hits_p0007.flat
+  G4String PointFileName(const G4String& filename, size_t point)
+  {
+    std::ostringstream tag;
+    tag << "_p" << std::setw(4) << std::setfill('0') << point;
+
+    const size_t dot = filename.find_last_of('.');
+    const size_t slash = filename.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+      return filename + tag.str();
+    return filename.substr(0, dot) + tag.str() + filename.substr(dot);
+  }
+
+} // namespace
+
+
+ParameterSweep& ParameterSweep::Instance()
+{
+  static ParameterSweep instance;
+  return instance;
+}
+
+
+ParameterSweep::ParameterSweep(): output_("sweep.jsonl"), hit_file_(""), msg_(nullptr)
+{
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/sweep/",
+                                "Control of the parameter sweeps.");
+
+  msg_->DeclareProperty("output", output_,
+                        "Name of the JSON-lines file with the run summary of "
+                        "every point (sweep.jsonl by default; no argument: none). "
+                        "It is overwritten by every sweep.")
+    .SetParameterName("filename", true)
+    .SetDefaultValue("")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareProperty("hitFile", hit_file_,
+                        "Hits file of the sweep points, tagged with the point "
+                        "number before the extension (empty: no hits).")
+    .SetParameterName("filename", true)
+    .SetDefaultValue("")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethod("run", &ParameterSweep::RunCommand,
+                      "Run a sweep: specification file and events per point.")
+    .SetParameterName("spec", false)
+    .SetToBeBroadcasted(false);
+}
+
+
+ParameterSweep::~ParameterSweep()
+{
+  delete msg_;
+}
+
+
+void ParameterSweep::RunCommand(const G4String& value)
+{
+  std::istringstream iss(value);
+  G4String filename;
+  G4int events = 0;
+  if (!(iss >> filename >> events) || events < 1) {
+    G4ExceptionDescription ed;
+    ed << "Invalid sweep '" << value << "' (expected filename events > 0).";
+    G4Exception("ParameterSweep::RunCommand()", "ParameterSweep", JustWarning, ed);
+    return;
+  }
+  Run(filename, events);
+}
+
+
+G4bool ParameterSweep::ReadSpecification(const G4String& filename)
+{
+  parameters_.clear();
+
+  std::ifstream in(filename);
+  if (!in) {
+    G4ExceptionDescription ed;
+    ed << "Cannot open sweep specification " << filename << ".";
+    G4Exception("ParameterSweep::ReadSpecification()", "ParameterSweep", JustWarning, ed);
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(in, line)) {
+    line = Trim(line.substr(0, line.find('#')));
+    if (line.empty()) continue;
+
+    Parameter parameter;
+    const size_t space = line.find_first_of(" \t");
+    parameter.command = line.substr(0, space);
+
+    std::istringstream values(space == std::string::npos ? "" : line.substr(space));
+    std::string value;
+    while (std::getline(values, value, ',')) {
+      value = Trim(value);
+      if (!value.empty()) parameter.values.push_back(value);
+    }
+
+    if (parameter.command[0] != '/' || parameter.values.empty()) {
+      G4ExceptionDescription ed;
+      ed << "Invalid sweep parameter '" << line << "' in " << filename
+         << " (expected a command followed by comma-separated values).";
+      G4Exception("ParameterSweep::ReadSpecification()", "ParameterSweep", JustWarning, ed);
+      return false;
+    }
+
+    parameters_.push_back(parameter);
+  }
+
+  return !parameters_.empty();
+}
+
+
+void ParameterSweep::Run(const G4String& filename, G4int events_per_point)
+{
+  if (!ReadSpecification(filename)) return;
+
+  size_t num_points = 1;
+  for (const Parameter& parameter: parameters_) num_points *= parameter.values.size();
+
+  std::ofstream out;
+  if (!output_.empty()) {
+    out.open(output_);
+    if (!out) {
+      G4ExceptionDescription ed;
+      ed << "Cannot open output file " << output_ << ".";
+      G4Exception("ParameterSweep::Run()", "ParameterSweep", JustWarning, ed);
+    }
+  }
+
+  G4UImanager* UI = G4UImanager::GetUIpointer();
+  G4RunManager* runmgr = G4RunManager::GetRunManager();
+
+  G4cout << "Parameter sweep: " << num_points << " points of "
+         << events_per_point << " events" << G4endl;
+
+  std::vector<size_t> index(parameters_.size()), previous;
+
+  for (size_t point=0; point<num_points; ++point) {
+
+    size_t rest = point;
+    for (size_t i=parameters_.size(); i-- > 0;) {
+      index[i] = rest % parameters_[i].values.size();
+      rest /= parameters_[i].values.size();
+    }
+
+    // Only the parameters that changed since the last point are applied,
+    // so that the geometry is not rebuilt needlessly
+    G4cout << "Sweep point " << point << ":";
+    for (size_t i=0; i<parameters_.size(); ++i) {
+      const G4String& value = parameters_[i].values[index[i]];
+      G4cout << ' ' << parameters_[i].command << ' ' << value << ';';
+      if (!previous.empty() && previous[i] == index[i]) continue;
+
+      const G4String command = parameters_[i].command + " " + value;
+      if (UI->ApplyCommand(command) != fCommandSucceeded) {
+        G4cout << G4endl;
+        G4ExceptionDescription ed;
+        ed << "Command '" << command << "' failed; sweep aborted.";
+        G4Exception("ParameterSweep::Run()", "ParameterSweep", JustWarning, ed);
+        return;
+      }
+    }
+    G4cout << G4endl;
+    previous = index;
+
+    if (!hit_file_.empty())
+      SimulationServer::SetOutput(PointFileName(hit_file_, point));
+
+    runmgr->BeamOn(events_per_point);
+
+    if (out.is_open()) {
+      out << "{\"point\": " << point << ", \"parameters\": {";
+      for (size_t i=0; i<parameters_.size(); ++i)
+        out << (i ? ", " : "") << Quote(parameters_[i].command) << ": "
+            << Quote(parameters_[i].values[index[i]]);
+      out << "}, \"summary\": " << RunSummary::Instance().GetLast() << "}\n";
+      out.flush();
+    }
+  }
+
+  if (!hit_file_.empty()) SimulationServer::SetOutput("");
+}
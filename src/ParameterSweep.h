@@ -0,0 +1,57 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | ParameterSweep.h
+//
+//  In-process parameter sweep: runs the same number of events at every
+//  point of a grid of parameter values, rebuilding the geometry between
+//  points without restarting the job (physics tables are kept as long as
+//  the materials do not change). The sweep specification is a text file
+//  with one parameter per line: a UI command followed by its values,
+//  separated by commas ('#' for comments), e.g.
+//
+//    /G4OpSim/geometry/plateThickness 3 mm, 4 mm, 5 mm
+//    /G4OpSim/geometry/sensorsPerSide 12, 24
+//
+//  Points are the Cartesian product of the grids (the last parameter
+//  varies fastest). The run summary of every point is appended, tagged
+//  with its parameter values, to a JSON-lines file.
+// -----------------------------------------------------------------------------
+
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include <globals.hh>
+
+#include <vector>
+
+class G4GenericMessenger;
+
+
+class ParameterSweep
+{
+public:
+  static ParameterSweep& Instance();
+
+  // Run the sweep specified in a file, with the given number of
+  // events per point. Must be called from the master thread.
+  void Run(const G4String& filename, G4int events_per_point);
+
+private:
+  ParameterSweep();
+  ~ParameterSweep();
+
+  void RunCommand(const G4String&); // "filename events"
+  G4bool ReadSpecification(const G4String& filename);
+
+private:
+  struct Parameter {
+    G4String command;
+    std::vector<G4String> values;
+  };
+
+  std::vector<Parameter> parameters_;
+  G4String output_;   // JSON lines, one per point
+  G4String hit_file_; // hits of point i go to <stem>_p<i><extension>
+  G4GenericMessenger* msg_;
+};
+
+#endif
@@ -0,0 +1,64 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PathRecordFormat.h
+//
+//  Layout of the photon path files: one fixed-size record per detected
+//  photon with what is needed to reweight its detection for different
+//  foil reflectivities and sensor efficiencies (see reader/PathReweighter.h)
+//  without tracking it again. All values are little-endian.
+//
+//    header   FileHeader
+//    records  Record[num_records]
+//
+//  This header does not depend on Geant4 so that it can be shared with the
+//  reader library.
+// -----------------------------------------------------------------------------
+
+#ifndef PATH_RECORD_FORMAT_H
+#define PATH_RECORD_FORMAT_H
+
+#include <cstdint>
+
+
+namespace PathRecordFormat {
+
+  const char kHeaderMagic[8] = {'G','4','O','S','P','A','T','H'};
+
+  const std::uint32_t kVersion = 1;
+
+  // Header and records are written straight from memory and mapped back
+  // by the reader, hence the little-endian requirement on both sides.
+  const bool kHostIsLittleEndian = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+  // Reflective surfaces whose reflections are counted
+  enum Surface { kBottomFoil = 0, kSideFoil, kNumSurfaces };
+
+  // Reflections before any WLS (at the emitted wavelength) and after
+  // the first one (at the detected wavelength). The wavelengths between
+  // the conversions of photons shifted more than once are not stored:
+  // their reflections count as after WLS, at the detected wavelength.
+  enum Phase { kBeforeWLS = 0, kAfterWLS, kNumPhases };
+
+  struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_surfaces;
+    std::uint64_t num_records;
+    std::uint64_t num_emitted; // primary photons of all events
+  };
+
+  struct Record {
+    std::int32_t event_id;
+    std::int32_t sensor_id;
+    float emitted_wavelength;  // nm
+    float detected_wavelength; // nm
+    std::uint16_t reflections[kNumSurfaces][kNumPhases]; // saturated at 65535
+    std::uint8_t num_wls;      // WLS conversions (saturated at 255)
+    std::uint8_t reserved[3];
+  };
+
+  static_assert(sizeof(FileHeader) == 32, "unexpected padding in FileHeader");
+  static_assert(sizeof(Record) == 28, "unexpected padding in Record");
+
+} // end namespace PathRecordFormat
+
+#endif
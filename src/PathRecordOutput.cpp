@@ -0,0 +1,130 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PathRecordOutput.cpp
+//
+//  Writer of photon path files.
+// -----------------------------------------------------------------------------
+
+#include "PathRecordOutput.h"
+#include "RunFileName.h"
+
+#include <G4GenericMessenger.hh>
+
+#include <cstring>
+
+
+static_assert(PathRecordFormat::kHostIsLittleEndian,
+              "Photon path files are little-endian; big-endian hosts are not supported.");
+
+
+PathRecordOutput& PathRecordOutput::Instance()
+{
+  static PathRecordOutput instance;
+  return instance;
+}
+
+
+PathRecordOutput::PathRecordOutput():
+  filename_(""), path_(""), open_(false), file_(nullptr),
+  num_records_(0), num_emitted_(0), num_missing_(0), msg_(nullptr)
+{
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/output/",
+                                "Control of the output.");
+
+  msg_->DeclareProperty("pathFile", filename_,
+                        "Name of the photon path file (empty: no output).")
+    .SetParameterName("filename", true)
+    .SetDefaultValue("")
+    .SetToBeBroadcasted(false);
+}
+
+
+PathRecordOutput::~PathRecordOutput()
+{
+  Close();
+  delete msg_;
+}
+
+
+void PathRecordOutput::Open(G4int run_id)
+{
+  if (open_ || filename_.empty()) return;
+
+  path_ = RunFileName(filename_, run_id);
+  file_ = std::fopen(path_.c_str(), "wb");
+  if (!file_) {
+    G4ExceptionDescription ed;
+    ed << "Cannot open output file " << path_ << ".";
+    G4Exception("PathRecordOutput::Open()", "PathRecordOutput", FatalException, ed);
+    return;
+  }
+
+  // Rewritten with the final counts when the file is closed
+  num_records_ = 0;
+  num_emitted_ = 0;
+  num_missing_ = 0;
+  WriteHeader();
+
+  open_ = true;
+
+  G4cout << "[PathRecordOutput] Writing photon paths to " << path_ << G4endl;
+}
+
+
+void PathRecordOutput::WriteHeader()
+{
+  PathRecordFormat::FileHeader header;
+  std::memcpy(header.magic, PathRecordFormat::kHeaderMagic, sizeof(header.magic));
+  header.version = PathRecordFormat::kVersion;
+  header.num_surfaces = PathRecordFormat::kNumSurfaces;
+  header.num_records = num_records_;
+  header.num_emitted = num_emitted_;
+
+  std::fseek(file_, 0, SEEK_SET);
+  std::fwrite(&header, sizeof(header), 1, file_);
+}
+
+
+void PathRecordOutput::Write(G4int event_id, G4long num_emitted,
+                             std::vector<PathRecordFormat::Record>& records,
+                             G4int num_missing)
+{
+  if (!open_) return;
+
+  for (PathRecordFormat::Record& record: records) record.event_id = event_id;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::fwrite(records.data(), sizeof(PathRecordFormat::Record), records.size(), file_);
+  num_records_ += records.size();
+  num_emitted_ += num_emitted;
+  num_missing_ += num_missing;
+}
+
+
+void PathRecordOutput::Close()
+{
+  if (!open_) return;
+
+  WriteHeader();
+
+  if (std::ferror(file_)) {
+    G4ExceptionDescription ed;
+    ed << "Error writing output file " << path_ << ".";
+    G4Exception("PathRecordOutput::Close()", "PathRecordOutput", JustWarning, ed);
+  }
+
+  // The reweighted efficiencies would be biased low
+  if (num_missing_ > 0) {
+    G4ExceptionDescription ed;
+    ed << num_missing_ << " detected photons had no path and are missing from "
+       << path_ << ".";
+    G4Exception("PathRecordOutput::Close()", "PathRecordOutput", JustWarning, ed);
+  }
+
+  std::fclose(file_);
+  file_ = nullptr;
+  open_ = false;
+
+  G4cout << "[PathRecordOutput] " << num_records_ << " photon paths ("
+         << num_emitted_ << " photons emitted) written to " << path_ << G4endl;
+}
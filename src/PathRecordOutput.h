@@ -0,0 +1,67 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PathRecordOutput.h
+//
+//  Writer of photon path files (see PathRecordFormat.h): one record per
+//  detected photon, appended by the worker threads at the end of every
+//  event under a lock. There is a single instance shared by all threads;
+//  the file is opened and closed by the master run action.
+// -----------------------------------------------------------------------------
+
+#ifndef PATH_RECORD_OUTPUT_H
+#define PATH_RECORD_OUTPUT_H
+
+#include "PathRecordFormat.h"
+
+#include <globals.hh>
+
+#include <vector>
+#include <mutex>
+#include <cstdio>
+
+class G4GenericMessenger;
+
+
+class PathRecordOutput
+{
+public:
+  static PathRecordOutput& Instance();
+
+  // Open the output file of a run (see RunFileName.h). Nothing is done
+  // if no file name has been configured.
+  void Open(G4int run_id);
+  // Write the final header and close the file.
+  void Close();
+
+  G4bool IsOpen() const;
+
+  // Append the records of an event, which had the given number of
+  // primary photons and of detected photons without a path (thread-safe)
+  void Write(G4int event_id, G4long num_emitted,
+             std::vector<PathRecordFormat::Record>&, G4int num_missing=0);
+
+private:
+  PathRecordOutput();
+  ~PathRecordOutput();
+  PathRecordOutput(const PathRecordOutput&) = delete;
+  PathRecordOutput& operator=(const PathRecordOutput&) = delete;
+
+  void WriteHeader();
+
+private:
+  G4String filename_;
+  G4String path_; // file written in the current run
+
+  G4bool open_;
+  std::FILE* file_;
+  std::uint64_t num_records_;
+  std::uint64_t num_emitted_;
+  std::uint64_t num_missing_; // detections that could not be recorded
+
+  std::mutex mutex_;
+
+  G4GenericMessenger* msg_;
+};
+
+inline G4bool PathRecordOutput::IsOpen() const { return open_; }
+
+#endif
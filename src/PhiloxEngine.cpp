@@ -0,0 +1,236 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PhiloxEngine.cpp
+//
+//  Counter-based random engine.
+// -----------------------------------------------------------------------------
+
+#include "PhiloxEngine.h"
+
+#include <globals.hh>
+
+#include <fstream>
+
+
+namespace {
+
+  const std::uint32_t kMultiplier0 = 0xD2511F53;
+  const std::uint32_t kMultiplier1 = 0xCD9E8D57;
+  const std::uint32_t kWeyl0 = 0x9E3779B9; // key schedule increments
+  const std::uint32_t kWeyl1 = 0xBB67AE85;
+  const int kRounds = 10;
+
+  inline std::uint32_t Low(std::uint64_t x)  { return static_cast<std::uint32_t>(x); }
+  inline std::uint32_t High(std::uint64_t x) { return static_cast<std::uint32_t>(x >> 32); }
+
+} // namespace
+
+
+PhiloxEngine::PhiloxEngine(long seed): CLHEP::HepRandomEngine()
+{
+  setSeed(seed, 0);
+}
+
+
+PhiloxEngine::~PhiloxEngine()
+{
+}
+
+
+void PhiloxEngine::Block(const std::uint32_t counter[4], const std::uint32_t key[2],
+                         std::uint32_t out[4])
+{
+  std::uint32_t x0 = counter[0], x1 = counter[1], x2 = counter[2], x3 = counter[3];
+  std::uint32_t k0 = key[0], k1 = key[1];
+
+  for (int r=0; r<kRounds; ++r) {
+    const std::uint64_t p0 = std::uint64_t(kMultiplier0) * x0;
+    const std::uint64_t p1 = std::uint64_t(kMultiplier1) * x2;
+    x0 = High(p1) ^ x1 ^ k0;
+    x1 = Low(p1);
+    x2 = High(p0) ^ x3 ^ k1;
+    x3 = Low(p0);
+    k0 += kWeyl0;
+    k1 += kWeyl1;
+  }
+
+  out[0] = x0; out[1] = x1; out[2] = x2; out[3] = x3;
+}
+
+
+void PhiloxEngine::Generate(int num_blocks, double* vect)
+{
+  std::uint64_t block = counter_[0] | (std::uint64_t(counter_[1]) << 32);
+
+  while (num_blocks > 0) {
+    // The rounds are applied to kLanes consecutive counters in lockstep
+    // (always all the lanes, so that the loops have a fixed length and
+    // can be vectorized by the compiler)
+    std::uint32_t x0[kLanes], x1[kLanes], x2[kLanes], x3[kLanes];
+    for (int l=0; l<kLanes; ++l) {
+      x0[l] = Low(block + l);
+      x1[l] = High(block + l);
+      x2[l] = counter_[2];
+      x3[l] = counter_[3];
+    }
+
+    std::uint32_t k0 = key_[0], k1 = key_[1];
+    for (int r=0; r<kRounds; ++r) {
+      for (int l=0; l<kLanes; ++l) {
+        const std::uint64_t p0 = std::uint64_t(kMultiplier0) * x0[l];
+        const std::uint64_t p1 = std::uint64_t(kMultiplier1) * x2[l];
+        x0[l] = High(p1) ^ x1[l] ^ k0;
+        x1[l] = Low(p1);
+        x2[l] = High(p0) ^ x3[l] ^ k1;
+        x3[l] = Low(p0);
+      }
+      k0 += kWeyl0;
+      k1 += kWeyl1;
+    }
+
+    const int n = (num_blocks < kLanes) ? num_blocks : kLanes;
+    for (int l=0; l<n; ++l) {
+      vect[4*l]   = ToDouble(x0[l]);
+      vect[4*l+1] = ToDouble(x1[l]);
+      vect[4*l+2] = ToDouble(x2[l]);
+      vect[4*l+3] = ToDouble(x3[l]);
+    }
+
+    block += n;
+    vect += 4*n;
+    num_blocks -= n;
+  }
+
+  counter_[0] = Low(block);
+  counter_[1] = High(block);
+}
+
+
+double PhiloxEngine::flat()
+{
+  if (index_ == 4) {
+    Block(counter_, key_, buffer_);
+    if (++counter_[0] == 0) ++counter_[1];
+    index_ = 0;
+  }
+  return ToDouble(buffer_[index_++]);
+}
+
+
+void PhiloxEngine::flatArray(const int size, double* vect)
+{
+  int i = 0;
+  // Rest of the current block first, to keep the sequence of flat()
+  while (i < size && index_ < 4) vect[i++] = ToDouble(buffer_[index_++]);
+
+  const int num_blocks = (size - i) / 4;
+  Generate(num_blocks, vect + i);
+  i += 4 * num_blocks;
+
+  while (i < size) vect[i++] = flat();
+}
+
+
+void PhiloxEngine::SetEvent(long run_seed, int run_id, int event_id)
+{
+  setSeed(run_seed, 0);
+  counter_[2] = static_cast<std::uint32_t>(run_id);
+  counter_[3] = static_cast<std::uint32_t>(event_id);
+}
+
+
+void PhiloxEngine::setSeed(long seed, int)
+{
+  theSeed = seed;
+  const std::uint64_t s = static_cast<std::uint64_t>(seed);
+  key_[0] = Low(s);
+  key_[1] = High(s);
+  counter_[0] = counter_[1] = counter_[2] = counter_[3] = 0;
+  buffer_[0] = buffer_[1] = buffer_[2] = buffer_[3] = 0;
+  index_ = 4;
+}
+
+
+void PhiloxEngine::setSeeds(const long* seeds, int)
+{
+  // Up to two seeds (zero-terminated list), one per key word
+  setSeed(seeds[0], 0);
+  if (seeds[0] != 0 && seeds[1] != 0)
+    key_[1] ^= static_cast<std::uint32_t>(seeds[1]);
+  theSeeds = seeds;
+}
+
+
+std::ostream& PhiloxEngine::put(std::ostream& os) const
+{
+  os << name() << "-begin\n"
+     << key_[0] << ' ' << key_[1] << '\n'
+     << counter_[0] << ' ' << counter_[1] << ' '
+     << counter_[2] << ' ' << counter_[3] << '\n'
+     << buffer_[0] << ' ' << buffer_[1] << ' '
+     << buffer_[2] << ' ' << buffer_[3] << '\n'
+     << index_ << '\n'
+     << name() << "-end\n";
+  return os;
+}
+
+
+std::istream& PhiloxEngine::get(std::istream& is)
+{
+  std::string begin, end;
+  is >> begin
+     >> key_[0] >> key_[1]
+     >> counter_[0] >> counter_[1] >> counter_[2] >> counter_[3]
+     >> buffer_[0] >> buffer_[1] >> buffer_[2] >> buffer_[3]
+     >> index_
+     >> end;
+
+  if (!is || begin != name() + "-begin" || end != name() + "-end" ||
+      index_ < 0 || index_ > 4) {
+    G4Exception("PhiloxEngine::get()", "PhiloxEngine", JustWarning,
+                "Invalid engine status in the input stream.");
+    is.setstate(std::ios::failbit);
+  }
+  return is;
+}
+
+
+void PhiloxEngine::saveStatus(const char filename[]) const
+{
+  std::ofstream out(filename);
+  put(out);
+  if (!out) {
+    G4ExceptionDescription ed;
+    ed << "Cannot write the engine status to " << filename << ".";
+    G4Exception("PhiloxEngine::saveStatus()", "PhiloxEngine", JustWarning, ed);
+  }
+}
+
+
+void PhiloxEngine::restoreStatus(const char filename[])
+{
+  std::ifstream in(filename);
+  if (!in) {
+    G4ExceptionDescription ed;
+    ed << "Cannot read the engine status from " << filename << ".";
+    G4Exception("PhiloxEngine::restoreStatus()", "PhiloxEngine", JustWarning, ed);
+    return;
+  }
+  get(in);
+}
+
+
+void PhiloxEngine::showStatus() const
+{
+  G4cout << "--------------- PhiloxEngine status ---------------\n"
+         << " Key:     " << key_[0] << ' ' << key_[1] << '\n'
+         << " Counter: " << counter_[0] << ' ' << counter_[1] << ' '
+         << counter_[2] << ' ' << counter_[3] << '\n'
+         << " Numbers left in the current block: " << 4 - index_ << '\n'
+         << "---------------------------------------------------" << G4endl;
+}
+
+
+std::string PhiloxEngine::name() const
+{
+  return "PhiloxEngine";
+}
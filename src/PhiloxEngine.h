@@ -0,0 +1,71 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PhiloxEngine.h
+//
+//  Counter-based random engine (Philox4x32-10, Salmon et al., SC'11): the
+//  n-th block of four 32-bit numbers is a keyed bijection of the counter n,
+//  so a stream can be positioned anywhere without generating what precedes
+//  it. The key is the run seed and the upper half of the counter holds the
+//  run and event IDs, which gives every event a stream of its own that does
+//  not depend on the thread processing it or on the events processed before.
+// -----------------------------------------------------------------------------
+
+#ifndef PHILOX_ENGINE_H
+#define PHILOX_ENGINE_H
+
+#include <CLHEP/Random/RandomEngine.h>
+
+#include <cstdint>
+#include <string>
+#include <iostream>
+
+
+class PhiloxEngine: public CLHEP::HepRandomEngine
+{
+public:
+  PhiloxEngine(long seed=0);
+  virtual ~PhiloxEngine();
+
+  // Rewind to the beginning of the stream of an event
+  void SetEvent(long run_seed, int run_id, int event_id);
+
+  // Uniform numbers in the open interval (0,1), 32 bits each. The values
+  // drawn in bulk are the same that as many calls to flat() would return;
+  // whole blocks are generated several at a time.
+  virtual double flat();
+  virtual void flatArray(const int size, double* vect);
+
+  // CLHEP seeding (the stream of run 0, event 0 of the seed). The seeds
+  // Geant4 sets before every event are ignored once SetEvent() is used.
+  virtual void setSeed(long seed, int);
+  virtual void setSeeds(const long* seeds, int);
+
+  virtual void saveStatus(const char filename[]="PhiloxEngine.conf") const;
+  virtual void restoreStatus(const char filename[]="PhiloxEngine.conf");
+  virtual void showStatus() const;
+  virtual std::string name() const;
+  virtual std::ostream& put(std::ostream&) const;
+  virtual std::istream& get(std::istream&);
+
+  // Philox4x32-10 block function (public for testing)
+  static void Block(const std::uint32_t counter[4], const std::uint32_t key[2],
+                    std::uint32_t out[4]);
+
+private:
+  // Generate the next num_blocks blocks into vect, as doubles
+  void Generate(int num_blocks, double* vect);
+
+  static double ToDouble(std::uint32_t);
+
+private:
+  static constexpr int kLanes = 8; // blocks generated together in bulk
+
+  std::uint32_t key_[2];
+  std::uint32_t counter_[4]; // block number (64 bits), run ID, event ID
+  std::uint32_t buffer_[4];  // current block
+  int index_;                // next unused number of the current block
+};
+
+inline double PhiloxEngine::ToDouble(std::uint32_t x)
+{ return (x + 0.5) * (1. / 4294967296.); }
+
+#endif
@@ -0,0 +1,154 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PhotonFate.cpp
+//
+//  Steps, boundary interactions and fates of optical photons per volume.
+// -----------------------------------------------------------------------------
+
+#include "PhotonFate.h"
+
+#include <G4LogicalVolumeStore.hh>
+#include <G4OpBoundaryProcess.hh>
+
+#include <algorithm>
+#include <iomanip>
+
+
+namespace {
+
+  const char* FateName(G4int fate)
+  {
+    static const char* names[PhotonFate::kNumFates] =
+      {"detected", "bulk-abs", "wls-abs", "surf-abs", "escaped", "other"};
+    return names[fate];
+  }
+
+  G4String BoundaryStatusName(G4int status)
+  {
+    switch (status) {
+      case Undefined:               return "Undefined";
+      case Transmission:            return "Transmission";
+      case FresnelRefraction:       return "FresnelRefraction";
+      case FresnelReflection:       return "FresnelReflection";
+      case TotalInternalReflection: return "TotalInternalReflection";
+      case LambertianReflection:    return "LambertianReflection";
+      case LobeReflection:          return "LobeReflection";
+      case SpikeReflection:         return "SpikeReflection";
+      case BackScattering:          return "BackScattering";
+      case Absorption:              return "Absorption";
+      case Detection:               return "Detection";
+      case NotAtBoundary:           return "NotAtBoundary";
+      case SameMaterial:            return "SameMaterial";
+      case StepTooSmall:            return "StepTooSmall";
+      case NoRINDEX:                return "NoRINDEX";
+      default:                      return "Status" + std::to_string(status);
+    }
+  }
+
+} // end namespace
+
+
+PhotonFate::PhotonFate(const G4String& name):
+  G4VAccumulable(name), num_volumes_(0)
+{
+}
+
+
+PhotonFate::~PhotonFate()
+{
+}
+
+
+void PhotonFate::Configure()
+{
+  num_volumes_ = 0;
+  for (const G4LogicalVolume* lv: *G4LogicalVolumeStore::GetInstance())
+    num_volumes_ = std::max(num_volumes_, lv->GetInstanceID() + 1);
+
+  steps_.assign(num_volumes_, 0);
+  boundary_.assign(num_volumes_ * kMaxBoundaryStatus, 0);
+  fates_.assign(num_volumes_ * kNumFates, 0);
+}
+
+
+void PhotonFate::Merge(const G4VAccumulable& other)
+{
+  const PhotonFate& worker = static_cast<const PhotonFate&>(other);
+
+  if (worker.num_volumes_ > num_volumes_) {
+    num_volumes_ = worker.num_volumes_;
+    steps_.resize(num_volumes_, 0);
+    boundary_.resize(num_volumes_ * kMaxBoundaryStatus, 0);
+    fates_.resize(num_volumes_ * kNumFates, 0);
+  }
+
+  for (size_t i=0; i<worker.steps_.size(); ++i)    steps_[i]    += worker.steps_[i];
+  for (size_t i=0; i<worker.boundary_.size(); ++i) boundary_[i] += worker.boundary_[i];
+  for (size_t i=0; i<worker.fates_.size(); ++i)    fates_[i]    += worker.fates_[i];
+}
+
+
+void PhotonFate::Reset()
+{
+  std::fill(steps_.begin(), steps_.end(), 0);
+  std::fill(boundary_.begin(), boundary_.end(), 0);
+  std::fill(fates_.begin(), fates_.end(), 0);
+}
+
+
+void PhotonFate::Print() const
+{
+  // Totals per fate
+  G4long totals[kNumFates] = {};
+  G4long num_photons = 0;
+  for (G4int v=0; v<num_volumes_; ++v) {
+    for (G4int f=0; f<kNumFates; ++f) {
+      totals[f] += fates_[v * kNumFates + f];
+      num_photons += fates_[v * kNumFates + f];
+    }
+  }
+
+  const std::streamsize precision = G4cout.precision();
+
+  G4cout << "Optical-photon fates (" << num_photons << " photons ended):";
+  for (G4int f=0; f<kNumFates; ++f) {
+    G4cout << ' ' << FateName(f) << ' ' << totals[f]
+           << " (" << std::fixed << std::setprecision(1)
+           << (num_photons ? 100. * totals[f] / num_photons : 0.) << "%)";
+  }
+  G4cout << std::defaultfloat << std::setprecision(precision) << G4endl;
+
+  // Volumes where something happened, in the order of the volume store
+  G4cout << "  " << std::left << std::setw(24) << "volume" << std::right
+         << std::setw(12) << "steps";
+  for (G4int f=0; f<kNumFates; ++f) G4cout << std::setw(10) << FateName(f);
+  G4cout << G4endl;
+
+  for (const G4LogicalVolume* lv: *G4LogicalVolumeStore::GetInstance()) {
+    const G4int v = lv->GetInstanceID();
+    if (v >= num_volumes_) continue;
+
+    const G4long* fates    = &fates_[v * kNumFates];
+    const G4long* boundary = &boundary_[v * kMaxBoundaryStatus];
+
+    const G4bool any_fate     = std::any_of(fates, fates + kNumFates,
+                                            [](G4long n){ return n > 0; });
+    const G4bool any_boundary = std::any_of(boundary, boundary + kMaxBoundaryStatus,
+                                            [](G4long n){ return n > 0; });
+
+    if (steps_[v] == 0 && !any_fate && !any_boundary) continue;
+
+    G4cout << "  " << std::left << std::setw(24) << lv->GetName() << std::right
+           << std::setw(12) << steps_[v];
+    for (G4int f=0; f<kNumFates; ++f) G4cout << std::setw(10) << fates[f];
+    G4cout << G4endl;
+
+    // Boundary interactions on entering (or bouncing off) the volume
+    if (!any_boundary) continue;
+    G4cout << "    boundary:";
+    for (G4int s=0; s<kMaxBoundaryStatus; ++s) {
+      if (boundary[s] == 0) continue;
+      G4cout << ' ' << BoundaryStatusName(s) << ' ' << boundary[s];
+    }
+    G4cout << G4endl;
+  }
+}
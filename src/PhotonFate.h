@@ -0,0 +1,80 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PhotonFate.h
+//
+//  Where optical photons go: number of steps, boundary interactions
+//  (by G4OpBoundaryProcessStatus) and fates of the photons, per logical
+//  volume. Thread-local accumulable merged into the master at the end of
+//  the run and printed as a compact report.
+// -----------------------------------------------------------------------------
+
+#ifndef PHOTON_FATE_H
+#define PHOTON_FATE_H
+
+#include <G4VAccumulable.hh>
+#include <G4LogicalVolume.hh>
+#include <globals.hh>
+
+#include <vector>
+
+
+class PhotonFate: public G4VAccumulable
+{
+public:
+  enum Fate { kDetected,        // detected by a sensor (post-step volume)
+              kBulkAbsorbed,    // absorbed in the bulk of the volume
+              kWLSAbsorbed,     // absorbed (and re-emitted) by WLS
+              kSurfaceAbsorbed, // absorbed at the surface of the volume (post-step volume)
+              kEscaped,         // left the world, the kill region or the envelope
+              kOther,           // any other reason (e.g. killed by the user)
+              kNumFates };
+
+  // Upper bound of the G4OpBoundaryProcessStatus values that are recorded
+  static constexpr G4int kMaxBoundaryStatus = 64;
+
+  PhotonFate(const G4String& name="PhotonFate");
+  virtual ~PhotonFate();
+
+  // Size the histograms for the logical volumes of the current geometry.
+  // Must be invoked at the beginning of every run in all threads, as the
+  // geometry may have been rebuilt since the previous one.
+  void Configure();
+
+  void Merge(const G4VAccumulable&) override;
+  void Reset() override;
+
+  void AddStep(const G4LogicalVolume*);
+  void AddBoundary(const G4LogicalVolume*, G4int status);
+  void AddFate(const G4LogicalVolume*, Fate);
+
+  // Print the (merged) report
+  void Print() const;
+
+private:
+  // Volumes are indexed by their instance ID, stable within a geometry
+  // and shared by all threads.
+  G4int num_volumes_;
+  std::vector<G4long> steps_;    // [volume]
+  std::vector<G4long> boundary_; // [volume][status]
+  std::vector<G4long> fates_;    // [volume][fate]
+};
+
+inline void PhotonFate::AddStep(const G4LogicalVolume* lv)
+{
+  const G4int id = lv->GetInstanceID();
+  if (id < num_volumes_) ++steps_[id];
+}
+
+inline void PhotonFate::AddBoundary(const G4LogicalVolume* lv, G4int status)
+{
+  const G4int id = lv->GetInstanceID();
+  if (id < num_volumes_ && status >= 0 && status < kMaxBoundaryStatus)
+    ++boundary_[id * kMaxBoundaryStatus + status];
+}
+
+inline void PhotonFate::AddFate(const G4LogicalVolume* lv, Fate fate)
+{
+  const G4int id = lv->GetInstanceID();
+  if (id < num_volumes_) ++fates_[id * kNumFates + fate];
+}
+
+#endif
@@ -0,0 +1,54 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PhotonPath.cpp
+//
+//  Track information of optical photons when photon paths are recorded.
+// -----------------------------------------------------------------------------
+
+#include "PhotonPath.h"
+
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+
+
+PhotonPath::PhotonPath(G4double emitted_wavelength):
+  G4VUserTrackInformation("PhotonPath"),
+  emitted_wavelength_(emitted_wavelength), num_wls_(0), reflections_()
+{
+}
+
+
+PhotonPath::~PhotonPath()
+{
+}
+
+
+void PhotonPath::Fill(PathRecordFormat::Record& record, G4int sensor_id,
+                      G4double detected_wavelength) const
+{
+  using namespace PathRecordFormat;
+
+  record.sensor_id = sensor_id;
+  record.emitted_wavelength = emitted_wavelength_ / nm;
+  record.detected_wavelength = detected_wavelength / nm;
+
+  for (G4int s=0; s<kNumSurfaces; ++s)
+    for (G4int p=0; p<kNumPhases; ++p)
+      record.reflections[s][p] = std::min(reflections_[s][p], 65535);
+
+  record.num_wls = std::min(num_wls_, 255);
+  std::fill(record.reserved, record.reserved + 3, 0);
+}
+
+
+void PhotonPath::Print() const
+{
+  using namespace PathRecordFormat;
+
+  G4cout << "PhotonPath: emitted at " << emitted_wavelength_/nm << " nm, "
+         << num_wls_ << " WLS conversions, reflections (before/after WLS): "
+         << "bottom foil " << reflections_[kBottomFoil][kBeforeWLS]
+         << "/" << reflections_[kBottomFoil][kAfterWLS]
+         << ", side foils " << reflections_[kSideFoil][kBeforeWLS]
+         << "/" << reflections_[kSideFoil][kAfterWLS] << G4endl;
+}
@@ -0,0 +1,48 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PhotonPath.h
+//
+//  Track information of optical photons when photon paths are recorded:
+//  wavelength at emission, number of WLS conversions and number of
+//  reflections on every foil (see PathRecordFormat.h). Photons re-emitted
+//  by WLS inherit a copy of the path of the absorbed photon.
+// -----------------------------------------------------------------------------
+
+#ifndef PHOTON_PATH_H
+#define PHOTON_PATH_H
+
+#include "PathRecordFormat.h"
+
+#include <G4VUserTrackInformation.hh>
+#include <globals.hh>
+
+
+class PhotonPath: public G4VUserTrackInformation
+{
+public:
+  PhotonPath(G4double emitted_wavelength);
+  virtual ~PhotonPath();
+
+  void AddReflection(PathRecordFormat::Surface);
+  void AddWLS();
+
+  // Fill everything but the event ID
+  void Fill(PathRecordFormat::Record&, G4int sensor_id,
+            G4double detected_wavelength) const;
+
+  virtual void Print() const;
+
+private:
+  G4double emitted_wavelength_;
+  G4int num_wls_;
+  G4int reflections_[PathRecordFormat::kNumSurfaces][PathRecordFormat::kNumPhases];
+};
+
+inline void PhotonPath::AddReflection(PathRecordFormat::Surface surface)
+{
+  ++reflections_[surface][num_wls_ > 0 ? PathRecordFormat::kAfterWLS :
+                                         PathRecordFormat::kBeforeWLS];
+}
+
+inline void PhotonPath::AddWLS() { ++num_wls_; }
+
+#endif
@@ -5,21 +5,53 @@
 // -----------------------------------------------------------------------------
 
 #include "PhysicsList.h"
+#include "UniformOpAbsorption.h"
+#include "UniformOpWLS.h"
 
 #include <G4EmStandardPhysics_option4.hh>
 #include <G4DecayPhysics.hh>
 #include <G4RadioactiveDecayPhysics.hh>
 #include <G4StepLimiterPhysics.hh>
 #include <G4OpticalPhysics.hh>
+#include <G4OpticalParameters.hh>
+#include <G4Geantino.hh>
+#include <G4Gamma.hh>
+#include <G4Electron.hh>
+#include <G4Positron.hh>
+#include <G4Proton.hh>
+#include <G4OpticalPhoton.hh>
+#include <G4ProcessManager.hh>
 
 
-PhysicsList::PhysicsList(): G4VModularPhysicsList()
+PhysicsList::PhysicsList(const G4String& mode, G4bool uniform_lookups,
+                         G4double uniform_tolerance):
+  G4VModularPhysicsList(), mode_(mode), uniform_lookups_(uniform_lookups),
+  uniform_tolerance_(uniform_tolerance)
 {
-  RegisterPhysics(new G4EmStandardPhysics_option4());
-  RegisterPhysics(new G4DecayPhysics());
-  RegisterPhysics(new G4RadioactiveDecayPhysics());
-  RegisterPhysics(new G4StepLimiterPhysics());
-  RegisterPhysics(new G4OpticalPhysics());
+  if (mode_ == "optical") {
+    // Only optical photons are transported: the processes for charged
+    // particles (Cerenkov and scintillation) and the Mie scattering are
+    // not built, and no EM or decay tables are computed at initialization.
+    G4OpticalParameters* params = G4OpticalParameters::Instance();
+    params->SetProcessActivation("Cerenkov", false);
+    params->SetProcessActivation("Scintillation", false);
+    params->SetProcessActivation("OpMieHG", false);
+    params->SetProcessActivation("OpWLS2", false);
+    RegisterPhysics(new G4OpticalPhysics());
+  }
+  else if (mode_ == "full") {
+    RegisterPhysics(new G4EmStandardPhysics_option4());
+    RegisterPhysics(new G4DecayPhysics());
+    RegisterPhysics(new G4RadioactiveDecayPhysics());
+    RegisterPhysics(new G4StepLimiterPhysics());
+    RegisterPhysics(new G4OpticalPhysics());
+  }
+  else {
+    G4ExceptionDescription ed;
+    ed << "Unknown physics mode '" << mode_ << "' (expected full or optical).";
+    G4Exception("PhysicsList::PhysicsList()", "PhysicsList",
+                FatalErrorInArgument, ed);
+  }
 }
 
 
@@ -28,6 +60,46 @@ PhysicsList::~PhysicsList()
 }
 
 
+void PhysicsList::ConstructParticle()
+{
+  G4VModularPhysicsList::ConstructParticle();
+
+  // The production-cuts table expects these particles to exist,
+  // even if no process is attached to them (optical mode).
+  G4Geantino::Definition();
+  G4Gamma::Definition();
+  G4Electron::Definition();
+  G4Positron::Definition();
+  G4Proton::Definition();
+}
+
+
+void PhysicsList::ConstructProcess()
+{
+  G4VModularPhysicsList::ConstructProcess();
+
+  if (!uniform_lookups_) return;
+
+  // Replace the absorption and WLS processes of the optical photon
+  // (in every thread). The optical physics constructor keeps no reference
+  // to the original processes, which are deleted here.
+  G4ProcessManager* pm = G4OpticalPhoton::Definition()->GetProcessManager();
+  G4ProcessVector* processes = pm->GetProcessList();
+
+  for (G4int i=G4int(processes->size())-1; i>=0; --i) {
+    G4VProcess* process = (*processes)[i];
+    if (process->GetProcessName() == "OpAbsorption") {
+      delete pm->RemoveProcess(process);
+      pm->AddDiscreteProcess(new UniformOpAbsorption(uniform_tolerance_));
+    }
+    else if (process->GetProcessName() == "OpWLS") {
+      delete pm->RemoveProcess(process);
+      pm->AddDiscreteProcess(new UniformOpWLS(uniform_tolerance_));
+    }
+  }
+}
+
+
 void PhysicsList::SetCuts()
 {
   G4VUserPhysicsList::SetCuts();
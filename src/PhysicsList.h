@@ -1,7 +1,12 @@
 // -----------------------------------------------------------------------------
 //  G4Basic | PhysicsList.h
 //
-//  
+//  Modular physics list with two configurations, chosen at construction:
+//  "full" (standard EM, decays and optical physics) and "optical", which
+//  only contains what the transport of optical photons needs. Optionally,
+//  the optical absorption and WLS processes are replaced with versions
+//  that look up the absorption lengths on uniform energy grids, resampled
+//  within the given relative tolerance.
 // -----------------------------------------------------------------------------
 
 #ifndef PHYSICS_LIST_H
@@ -13,9 +18,21 @@
 class PhysicsList: public G4VModularPhysicsList
 {
 public:
-  PhysicsList();
+  PhysicsList(const G4String& mode="full", G4bool uniform_lookups=false,
+              G4double uniform_tolerance=1.e-3);
   virtual ~PhysicsList();
+  virtual void ConstructParticle();
+  virtual void ConstructProcess();
   virtual void SetCuts();
+
+  const G4String& GetMode() const;
+
+private:
+  G4String mode_;
+  G4bool uniform_lookups_;
+  G4double uniform_tolerance_;
 };
 
+inline const G4String& PhysicsList::GetMode() const { return mode_; }
+
 #endif
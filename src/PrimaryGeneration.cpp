@@ -5,75 +5,519 @@
 // -----------------------------------------------------------------------------
 
 #include "PrimaryGeneration.h"
+#include "VisibilityBuilder.h"
+#include "VisibilityLibrary.h"
+#include "PhiloxEngine.h"
+#include "DetectorConstruction.h"
 
 #include <G4SystemOfUnits.hh>
 #include <G4PhysicalConstants.hh>
 #include <G4OpticalPhoton.hh>
 #include <G4ParticleDefinition.hh>
-#include <G4SystemOfUnits.hh>
 #include <G4PrimaryParticle.hh>
 #include <G4PrimaryVertex.hh>
 #include <G4Event.hh>
-#include <G4RandomDirection.hh>
+#include <G4GenericMessenger.hh>
+#include <G4Poisson.hh>
+#include <G4RunManager.hh>
+#include <G4Run.hh>
+#include <Randomize.hh>
 
 
 PrimaryGeneration::PrimaryGeneration():
   G4VUserPrimaryGeneratorAction(),
-  kinetic_energy_(6*eV)
+  opticalphoton_(G4OpticalPhoton::Definition()),
+  mode_("photons"),
+  num_photons_(1),
+  position_mode_("point"),
+  position_(0., 10.*cm, 0.),
+  line_end_(0., 10.*cm, 0.),
+  half_size_(0., 0., 0.),
+  radius_(0.),
+  direction_mode_("fixed"),
+  direction_(0., -1., 0.),
+  energy_mode_("mono"),
+  kinetic_energy_(6*eV),
+  energy_min_(2.*eV), energy_max_(4.*eV),
+  flash_yield_(40000.), flash_energy_(1.*MeV), flash_fluctuate_(true),
+  scan_voxel_(-1), num_emitted_(0),
+  counter_based_(false), run_seed_(12345),
+  engine_(nullptr), default_engine_(nullptr),
+  msg_(nullptr), flash_msg_(nullptr), random_msg_(nullptr)
 {
+  DefineCommands();
 }
 
 
 PrimaryGeneration::~PrimaryGeneration()
 {
+  delete msg_;
+  delete flash_msg_;
+  delete random_msg_;
+
+  if (engine_) {
+    if (G4Random::getTheEngine() == engine_) G4Random::setTheEngine(default_engine_);
+    delete engine_;
+  }
+}
+
+
+void PrimaryGeneration::DefineCommands()
+{
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/generator/",
+                                "Control of the primary generation.");
+
+  msg_->DeclareProperty("mode", mode_,
+                        "Generation mode: N photons from a single vertex, "
+                        "LAr scintillation flash, visibility-library voxel "
+                        "scan or fast (library-based) flash.")
+    .SetParameterName("mode", false)
+    .SetCandidates("photons flash scan fast");
+
+  msg_->DeclareProperty("numPhotons", num_photons_,
+                        "Number of optical photons generated per vertex.")
+    .SetParameterName("n", false)
+    .SetRange("n>0");
+
+  msg_->DeclareProperty("positionMode", position_mode_,
+                        "Distribution of the vertex position.")
+    .SetParameterName("mode", false)
+    .SetCandidates("point line box sphere");
+
+  msg_->DeclarePropertyWithUnit("position", "cm", position_,
+                                "Vertex position (start of the line, "
+                                "centre of the box or sphere).");
+
+  msg_->DeclarePropertyWithUnit("lineEnd", "cm", line_end_,
+                                "End point of the vertex line.");
+
+  msg_->DeclarePropertyWithUnit("halfSize", "cm", half_size_,
+                                "Half-lengths of the vertex box.");
+
+  msg_->DeclarePropertyWithUnit("radius", "cm", radius_,
+                                "Radius of the vertex sphere.")
+    .SetParameterName("radius", false)
+    .SetRange("radius>=0.");
+
+  msg_->DeclareProperty("directionMode", direction_mode_,
+                        "Distribution of the photon momentum direction.")
+    .SetParameterName("mode", false)
+    .SetCandidates("fixed isotropic");
+
+  msg_->DeclareProperty("direction", direction_,
+                        "Momentum direction of the photons (fixed mode).");
+
+  msg_->DeclareProperty("energyMode", energy_mode_,
+                        "Energy spectrum of the photons.")
+    .SetParameterName("mode", false)
+    .SetCandidates("mono flat");
+
+  msg_->DeclarePropertyWithUnit("energy", "eV", kinetic_energy_,
+                                "Photon energy (mono mode).")
+    .SetParameterName("energy", false)
+    .SetRange("energy>0.");
+
+  msg_->DeclarePropertyWithUnit("energyMin", "eV", energy_min_,
+                                "Lower limit of the photon energy (flat mode).")
+    .SetParameterName("energy", false)
+    .SetRange("energy>0.");
+
+  msg_->DeclarePropertyWithUnit("energyMax", "eV", energy_max_,
+                                "Upper limit of the photon energy (flat mode).")
+    .SetParameterName("energy", false)
+    .SetRange("energy>0.");
+
+  flash_msg_ = new G4GenericMessenger(this, "/G4OpSim/generator/flash/",
+                                      "Control of the LAr scintillation flashes.");
+
+  flash_msg_->DeclareProperty("yield", flash_yield_,
+                              "Scintillation yield, in photons per MeV.")
+    .SetParameterName("yield", false)
+    .SetRange("yield>=0.");
+
+  flash_msg_->DeclarePropertyWithUnit("energyDeposit", "MeV", flash_energy_,
+                                      "Energy deposited in every flash.")
+    .SetParameterName("energy", false)
+    .SetRange("energy>=0.");
+
+  flash_msg_->DeclareProperty("fluctuate", flash_fluctuate_,
+                              "Poisson-fluctuate the number of photons.");
+
+  flash_msg_->DeclareMethod("singletFraction",
+                            &PrimaryGeneration::SetSingletFraction,
+                            "Fraction of photons from the singlet component.")
+    .SetParameterName("fraction", false)
+    .SetRange("fraction>=0. && fraction<=1.");
+
+  flash_msg_->DeclareMethodWithUnit("singletLifetime", "ns",
+                                    &PrimaryGeneration::SetSingletLifetime,
+                                    "Lifetime of the singlet component.")
+    .SetParameterName("tau", false)
+    .SetRange("tau>0.");
+
+  flash_msg_->DeclareMethodWithUnit("tripletLifetime", "ns",
+                                    &PrimaryGeneration::SetTripletLifetime,
+                                    "Lifetime of the triplet component.")
+    .SetParameterName("tau", false)
+    .SetRange("tau>0.");
+
+  flash_msg_->DeclareMethodWithUnit("peakWavelength", "nm",
+                                    &PrimaryGeneration::SetPeakWavelength,
+                                    "Peak wavelength of the emission spectrum.")
+    .SetParameterName("lambda", false)
+    .SetRange("lambda>0.");
+
+  flash_msg_->DeclareMethodWithUnit("fwhm", "nm",
+                                    &PrimaryGeneration::SetFWHM,
+                                    "Full width at half maximum of the emission spectrum.")
+    .SetParameterName("width", false)
+    .SetRange("width>0.");
+
+  random_msg_ = new G4GenericMessenger(this, "/G4OpSim/random/",
+                                       "Control of the random number streams.");
+
+  random_msg_->DeclareProperty("counterBased", counter_based_,
+                               "Draw the random numbers of every event from a "
+                               "counter-based stream keyed by the run seed and "
+                               "the event ID (results independent of the number "
+                               "of threads).");
+
+  random_msg_->DeclareProperty("seed", run_seed_,
+                               "Run seed of the counter-based streams.")
+    .SetParameterName("seed", false);
 }
 
 
 void PrimaryGeneration::GeneratePrimaries(G4Event* event)
 {
-  // Generate a random momentum direction for the photon
+  scan_voxel_ = -1;
+  num_emitted_ = 0;
+  detections_.clear();
 
-  G4double cost = 1. - 2.*G4UniformRand();
-  G4double sint = std::sqrt((1.-cost)*(1.+cost));
+  SeedEvent(event);
 
-  G4double phi = twopi*G4UniformRand();
-  G4double sinp = std::sin(phi);
-  G4double cosp = std::cos(phi);
+  if (mode_ == "flash") GenerateFlash(event);
+  else if (mode_ == "scan") GenerateScan(event);
+  else if (mode_ == "fast") GenerateFast(event);
+  else GeneratePhotons(event);
+}
 
-  G4double px = sint*cosp;
-  G4double py = sint*sinp;
-  G4double pz = cost;
 
-  //G4ThreeVector momentum(px,py,pz);
-  G4ThreeVector momentum(0.,-1,0.);
-  //G4ThreeVector momentum(0.,-0.99,sqrt(1-0.99*0.99));
+void PrimaryGeneration::SeedEvent(const G4Event* event)
+{
+  // Geant4 reseeds the engine of a worker before every event with seeds
+  // drawn by the master in the order the events are dispatched; the
+  // counter-based stream replaces them here, before any number is drawn
+  // for the event (the primaries and then its tracking).
+  if (!counter_based_) {
+    if (engine_ && G4Random::getTheEngine() == engine_)
+      G4Random::setTheEngine(default_engine_);
+    return;
+  }
 
-  // Determine the polarization of the photon
+  if (!engine_) {
+    engine_ = new PhiloxEngine();
+    default_engine_ = G4Random::getTheEngine();
+  }
+  if (G4Random::getTheEngine() != engine_) G4Random::setTheEngine(engine_);
 
-  G4double sx = cost*cosp;
-  G4double sy = cost*sinp;
-  G4double sz = -sint;
+  const G4RunManager* runmgr = G4RunManager::GetRunManager();
+  const G4Run* run = runmgr ? runmgr->GetCurrentRun() : nullptr;
+  engine_->SetEvent(run_seed_, run ? run->GetRunID() : 0, event->GetEventID());
+}
 
-  G4ThreeVector polarization(sx, sy, sz);
 
-  G4ThreeVector perp = momentum.cross(polarization);
+void PrimaryGeneration::GeneratePhotons(G4Event* event)
+{
+  // Sample all the photon properties in batches into the reused arrays
+  // (with one call to the random engine per batch) and create the
+  // primary particles afterwards.
 
-  phi  = twopi*G4UniformRand();
-  sinp = std::sin(phi);
-  cosp = std::cos(phi);
+  const G4int n = num_emitted_ = num_photons_;
 
-  polarization = cosp * polarization + sinp * perp;
-  polarization = polarization.unit();
+  SampleDirections(n, direction_mode_ == "isotropic");
+  SamplePolarizations(n);
+  SampleEnergies(n);
 
-  // Create a new photon
+  G4double rnd[3] = {0., 0., 0.};
+  if (position_mode_ != "point") G4Random::getTheEngine()->flatArray(3, rnd);
 
-  G4PrimaryParticle* particle = new G4PrimaryParticle(G4OpticalPhoton::Definition());
-  particle->SetMomentumDirection(momentum);
-  particle->SetPolarization(polarization);
-  particle->SetKineticEnergy(kinetic_energy_);
+  G4PrimaryVertex* vertex = new G4PrimaryVertex(SamplePosition(rnd), 0.);
 
-  G4PrimaryVertex* vertex = new G4PrimaryVertex(G4ThreeVector(0.,10.*cm,0.), 0.);
-  vertex->SetPrimary(particle);
+  for (G4int i=0; i<n; ++i) {
+    G4PrimaryParticle* particle = new G4PrimaryParticle(opticalphoton_);
+    particle->SetMomentumDirection(directions_[i]);
+    particle->SetPolarization(polarizations_[i]);
+    particle->SetKineticEnergy(energies_[i]);
+    vertex->SetPrimary(particle);
+  }
 
   event->AddPrimaryVertex(vertex);
 }
+
+
+void PrimaryGeneration::GenerateFlash(G4Event* event)
+{
+  // Isotropic, randomly polarized photons following the LAr emission
+  // spectrum and time profile. Every photon has its own vertex, since
+  // both the emission point and time differ from photon to photon.
+
+  const G4int n = num_emitted_ = SampleFlashSize();
+
+  scintillation_.Update();
+
+  SamplePositions(n);
+  SampleDirections(n, true);
+  SamplePolarizations(n);
+  SampleScintillation(n);
+
+  for (G4int i=0; i<n; ++i) {
+    G4PrimaryParticle* particle = new G4PrimaryParticle(opticalphoton_);
+    particle->SetMomentumDirection(directions_[i]);
+    particle->SetPolarization(polarizations_[i]);
+    particle->SetKineticEnergy(energies_[i]);
+
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(positions_[i], times_[i]);
+    vertex->SetPrimary(particle);
+    event->AddPrimaryVertex(vertex);
+  }
+}
+
+
+void PrimaryGeneration::GenerateScan(G4Event* event)
+{
+  // Photons with the LAr spectrum, emitted isotropically at t=0 from
+  // random points of the voxel assigned to this event. Their hits are
+  // added to the library by the event action.
+
+  VisibilityBuilder& builder = VisibilityBuilder::Instance();
+
+  scan_voxel_ = builder.GetVoxelForEvent(event->GetEventID());
+  G4ThreeVector vmin, vmax;
+  builder.GetVoxelBounds(scan_voxel_, vmin, vmax);
+
+  const G4int n = num_emitted_ = num_photons_;
+
+  scintillation_.Update();
+
+  SampleDirections(n, true);
+  SamplePolarizations(n);
+  SampleScintillation(n);
+
+  random_.resize(3*n);
+  G4Random::getTheEngine()->flatArray(3*n, random_.data());
+
+  for (G4int i=0; i<n; ++i) {
+    const G4double* rnd = &random_[3*i];
+    G4ThreeVector position(vmin.x() + rnd[0] * (vmax.x() - vmin.x()),
+                           vmin.y() + rnd[1] * (vmax.y() - vmin.y()),
+                           vmin.z() + rnd[2] * (vmax.z() - vmin.z()));
+
+    G4PrimaryParticle* particle = new G4PrimaryParticle(opticalphoton_);
+    particle->SetMomentumDirection(directions_[i]);
+    particle->SetPolarization(polarizations_[i]);
+    particle->SetKineticEnergy(energies_[i]);
+
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(position, 0.);
+    vertex->SetPrimary(particle);
+    event->AddPrimaryVertex(vertex);
+  }
+}
+
+
+void PrimaryGeneration::BeginOfRun()
+{
+  if (mode_ != "fast") return;
+
+  const VisibilityLibrary& library = VisibilityLibrary::Instance();
+
+  if (!library.IsLoaded()) {
+    G4Exception("PrimaryGeneration::BeginOfRun()", "PrimaryGeneration",
+                FatalException, "No visibility library has been loaded.");
+    return;
+  }
+
+  // A library built for another geometry would assign its detections
+  // to the wrong sensors, or leave some of them empty
+  const DetectorConstruction* detector = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+
+  if (detector && library.GetNumSensors() != detector->GetNumberOfSensors()) {
+    G4ExceptionDescription ed;
+    ed << "The visibility library has " << library.GetNumSensors()
+       << " sensors, but the detector has " << detector->GetNumberOfSensors() << ".";
+    G4Exception("PrimaryGeneration::BeginOfRun()", "PrimaryGeneration",
+                FatalException, ed);
+  }
+}
+
+
+void PrimaryGeneration::GenerateFast(G4Event*)
+{
+  // The photons of the flash are only used to count how many are emitted
+  // in every voxel of the library. The number of photons detected by each
+  // sensor is then drawn from a Poisson distribution with mean equal to
+  // that count times the detection probability, and the detection times
+  // are the sum of an emission time and an arrival time from the library.
+  // No primary particle is created: the event action fills the hits.
+
+  const VisibilityLibrary& library = VisibilityLibrary::Instance();
+
+  if (!library.IsLoaded()) {
+    G4Exception("PrimaryGeneration::GenerateFast()", "PrimaryGeneration",
+                FatalException, "No visibility library has been loaded.");
+    return;
+  }
+
+  const G4int n = num_emitted_ = SampleFlashSize();
+
+  scintillation_.Update();
+  SamplePositions(n);
+
+  voxel_photons_.resize(library.GetNumVoxels());
+  voxels_.clear();
+
+  for (G4int i=0; i<n; ++i) {
+    G4int voxel = library.GetVoxel(positions_[i]);
+    if (voxel < 0) continue; // outside the library: never detected
+    if (voxel_photons_[voxel]++ == 0) voxels_.push_back(voxel);
+  }
+
+  const G4int num_sensors = library.GetNumSensors();
+
+  for (G4int voxel: voxels_) {
+    const float* probability = library.GetProbabilities(voxel);
+    for (G4int s=0; s<num_sensors; ++s) {
+      if (probability[s] <= 0.) continue;
+      G4int k = G4Poisson(voxel_photons_[voxel] * probability[s]);
+      if (k == 0) continue;
+
+      random_.resize(4*k);
+      G4Random::getTheEngine()->flatArray(4*k, random_.data());
+      for (G4int j=0; j<k; ++j) {
+        const G4double* rnd = &random_[4*j];
+        G4double time = scintillation_.SampleTime(rnd[0], rnd[1]) +
+                        library.SampleTime(voxel, s, rnd[2], rnd[3]);
+        detections_.push_back({s, time});
+      }
+    }
+    voxel_photons_[voxel] = 0;
+  }
+}
+
+
+G4int PrimaryGeneration::SampleFlashSize() const
+{
+  const G4double mean = flash_yield_ * flash_energy_/MeV;
+  return flash_fluctuate_ ? G4int(G4Poisson(mean)) : G4int(mean + 0.5);
+}
+
+
+G4ThreeVector PrimaryGeneration::SamplePosition(const G4double* rnd) const
+{
+  if (position_mode_ == "line") {
+    return position_ + rnd[0] * (line_end_ - position_);
+  }
+  else if (position_mode_ == "box") {
+    return position_ + G4ThreeVector((2.*rnd[0]-1.) * half_size_.x(),
+                                     (2.*rnd[1]-1.) * half_size_.y(),
+                                     (2.*rnd[2]-1.) * half_size_.z());
+  }
+  else if (position_mode_ == "sphere") {
+    G4double r    = radius_ * std::cbrt(rnd[0]);
+    G4double cost = 1. - 2.*rnd[1];
+    G4double sint = std::sqrt((1.-cost)*(1.+cost));
+    G4double phi  = twopi*rnd[2];
+    return position_ + r * G4ThreeVector(sint*std::cos(phi), sint*std::sin(phi), cost);
+  }
+
+  return position_;
+}
+
+
+void PrimaryGeneration::SamplePositions(G4int n)
+{
+  positions_.resize(n);
+
+  if (position_mode_ == "point") {
+    for (G4int i=0; i<n; ++i) positions_[i] = position_;
+    return;
+  }
+
+  random_.resize(3*n);
+  G4Random::getTheEngine()->flatArray(3*n, random_.data());
+
+  for (G4int i=0; i<n; ++i) positions_[i] = SamplePosition(&random_[3*i]);
+}
+
+
+void PrimaryGeneration::SampleDirections(G4int n, G4bool isotropic)
+{
+  directions_.resize(n);
+
+  if (isotropic) {
+    random_.resize(2*n);
+    G4Random::getTheEngine()->flatArray(2*n, random_.data());
+
+    for (G4int i=0; i<n; ++i) {
+      G4double cost = 1. - 2.*random_[2*i];
+      G4double sint = std::sqrt((1.-cost)*(1.+cost));
+      G4double phi  = twopi*random_[2*i+1];
+      directions_[i].set(sint*std::cos(phi), sint*std::sin(phi), cost);
+    }
+  }
+  else {
+    const G4ThreeVector direction = direction_.unit();
+    for (G4int i=0; i<n; ++i) directions_[i] = direction;
+  }
+}
+
+
+void PrimaryGeneration::SamplePolarizations(G4int n)
+{
+  // The polarization is a random unit vector perpendicular to
+  // the momentum direction (i.e. the photons are unpolarized).
+
+  polarizations_.resize(n);
+  random_.resize(n);
+  G4Random::getTheEngine()->flatArray(n, random_.data());
+
+  for (G4int i=0; i<n; ++i) {
+    const G4ThreeVector& dir = directions_[i];
+    G4ThreeVector e1 = dir.orthogonal().unit();
+    G4ThreeVector e2 = dir.cross(e1);
+    G4double phi = twopi*random_[i];
+    polarizations_[i] = std::cos(phi) * e1 + std::sin(phi) * e2;
+  }
+}
+
+
+void PrimaryGeneration::SampleEnergies(G4int n)
+{
+  energies_.resize(n);
+
+  if (energy_mode_ == "flat") {
+    G4Random::getTheEngine()->flatArray(n, energies_.data());
+    for (G4int i=0; i<n; ++i)
+      energies_[i] = energy_min_ + energies_[i] * (energy_max_ - energy_min_);
+  }
+  else {
+    for (G4int i=0; i<n; ++i) energies_[i] = kinetic_energy_;
+  }
+}
+
+
+void PrimaryGeneration::SampleScintillation(G4int n)
+{
+  energies_.resize(n);
+  times_.resize(n);
+
+  random_.resize(4*n);
+  G4Random::getTheEngine()->flatArray(4*n, random_.data());
+
+  for (G4int i=0; i<n; ++i) {
+    const G4double* rnd = &random_[4*i];
+    energies_[i] = scintillation_.SampleEnergy(rnd[0], rnd[1]);
+    times_[i]    = scintillation_.SampleTime(rnd[2], rnd[3]);
+  }
+}
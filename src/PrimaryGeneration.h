@@ -7,10 +7,18 @@
 #ifndef PRIMARY_GENERATION_H
 #define PRIMARY_GENERATION_H
 
+#include "LArScintillation.h"
+
 #include <G4VUserPrimaryGeneratorAction.hh>
+#include <G4ThreeVector.hh>
 #include <globals.hh>
 
+#include <vector>
+
 class G4ParticleDefinition;
+class G4GenericMessenger;
+class PhiloxEngine;
+namespace CLHEP { class HepRandomEngine; }
 
 
 class PrimaryGeneration: public G4VUserPrimaryGeneratorAction
@@ -20,8 +28,122 @@ public:
   virtual ~PrimaryGeneration();
   virtual void GeneratePrimaries(G4Event*);
 
+  // Check the configuration against the geometry before the events of a
+  // run (fast mode: the library must cover the sensors of the detector)
+  void BeginOfRun();
+
+  // A photon detection sampled from the visibility library (fast mode)
+  struct Detection {
+    G4int sensor_id;
+    G4double time;
+  };
+
+  // Voxel scanned by the current event (-1 if not in scan mode)
+  G4int GetScanVoxel() const;
+  // Number of photons emitted in the current event
+  G4int GetNumEmitted() const;
+  // Detections of the current event in fast mode
+  const std::vector<Detection>& GetDetections() const;
+
+private:
+  void DefineCommands();
+
+  void SetSingletFraction(G4double);
+  void SetSingletLifetime(G4double);
+  void SetTripletLifetime(G4double);
+  void SetPeakWavelength(G4double);
+  void SetFWHM(G4double);
+
+  // Counter-based random numbers: install the Philox engine as the
+  // random engine of the thread and rewind it to the stream of the event
+  void SeedEvent(const G4Event*);
+
+  // Photons mode: N photons from a single vertex
+  void GeneratePhotons(G4Event*);
+  // Flash mode: LAr scintillation photons, each with its own vertex
+  void GenerateFlash(G4Event*);
+  // Scan mode: photons emitted uniformly in one voxel of the visibility grid
+  void GenerateScan(G4Event*);
+  // Fast mode: flash photons detected according to the visibility library,
+  // without any particle being tracked
+  void GenerateFast(G4Event*);
+
+  // Number of photons of a flash
+  G4int SampleFlashSize() const;
+
+  // Vertex position from three uniform random numbers
+  G4ThreeVector SamplePosition(const G4double* rnd) const;
+
+  // Fill the batch arrays for the given number of photons
+  void SamplePositions(G4int);
+  void SampleDirections(G4int, G4bool isotropic);
+  void SamplePolarizations(G4int);
+  void SampleEnergies(G4int);
+  void SampleScintillation(G4int);
+
 private:
+  G4ParticleDefinition* opticalphoton_;
+
+  G4String mode_; // photons, flash, scan or fast
+
+  G4int num_photons_; // photons per vertex
+
+  G4String position_mode_; // point, line, box or sphere
+  G4ThreeVector position_;
+  G4ThreeVector line_end_;
+  G4ThreeVector half_size_;
+  G4double radius_;
+
+  G4String direction_mode_; // fixed or isotropic
+  G4ThreeVector direction_;
+
+  G4String energy_mode_; // mono or flat
   G4double kinetic_energy_;
+  G4double energy_min_, energy_max_;
+
+  LArScintillation scintillation_;
+  G4double flash_yield_;   // photons per MeV
+  G4double flash_energy_;  // energy deposit
+  G4bool flash_fluctuate_; // Poisson fluctuations of the number of photons
+
+  G4int scan_voxel_;
+  G4int num_emitted_;
+  std::vector<G4int> voxel_photons_; // photons per voxel (fast mode)
+  std::vector<G4int> voxels_;        // voxels with photons (fast mode)
+  std::vector<Detection> detections_;
+
+  // Batch buffers, reused from event to event
+  std::vector<G4double> random_;
+  std::vector<G4ThreeVector> positions_;
+  std::vector<G4ThreeVector> directions_;
+  std::vector<G4ThreeVector> polarizations_;
+  std::vector<G4double> energies_;
+  std::vector<G4double> times_;
+
+  G4bool counter_based_; // per-event random streams from (seed, event ID)
+  G4int run_seed_;
+  PhiloxEngine* engine_;
+  CLHEP::HepRandomEngine* default_engine_; // restored when disabled
+
+  G4GenericMessenger* msg_;
+  G4GenericMessenger* flash_msg_;
+  G4GenericMessenger* random_msg_;
 };
 
+inline G4int PrimaryGeneration::GetScanVoxel() const { return scan_voxel_; }
+inline G4int PrimaryGeneration::GetNumEmitted() const { return num_emitted_; }
+inline const std::vector<PrimaryGeneration::Detection>&
+  PrimaryGeneration::GetDetections() const { return detections_; }
+
+inline void PrimaryGeneration::SetSingletFraction(G4double f)
+{ scintillation_.SetSingletFraction(f); }
+inline void PrimaryGeneration::SetSingletLifetime(G4double t)
+{ scintillation_.SetSingletLifetime(t); }
+inline void PrimaryGeneration::SetTripletLifetime(G4double t)
+{ scintillation_.SetTripletLifetime(t); }
+inline void PrimaryGeneration::SetPeakWavelength(G4double l)
+{ scintillation_.SetPeakWavelength(l); }
+inline void PrimaryGeneration::SetFWHM(G4double w)
+{ scintillation_.SetFWHM(w); }
+
 #endif
@@ -0,0 +1,257 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PropertyLoader.cpp
+//
+//  Loading of tabulated optical properties from CSV files.
+// -----------------------------------------------------------------------------
+
+#include "PropertyLoader.h"
+
+#include <G4MaterialPropertiesTable.hh>
+#include <G4PhysicalConstants.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef G4OPSIM_DATA_DIR
+#define G4OPSIM_DATA_DIR "data"
+#endif
+
+
+namespace {
+
+  const char kCacheMagic[8] = {'G','4','O','S','S','P','E','C'};
+  const std::uint32_t kCacheVersion = 1;
+
+  struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t num_entries;
+    // followed by energies[num_entries] and values[num_entries] (double)
+  };
+
+  // 64-bit FNV-1a hash
+  std::uint64_t Hash(const void* data, std::size_t n,
+                     std::uint64_t h=14695981039346656037ULL)
+  {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i=0; i<n; ++i) { h ^= p[i]; h *= 1099511628211ULL; }
+    return h;
+  }
+
+  G4String CacheDirectory()
+  {
+    const char* dir = std::getenv("G4OPSIM_CACHE");
+    if (dir) return dir;
+    const char* tmp = std::getenv("TMPDIR");
+    return G4String(tmp && *tmp ? tmp : "/tmp") + "/G4OpSim-cache";
+  }
+
+  G4String CachePath(std::uint64_t key)
+  {
+    const G4String dir = CacheDirectory();
+    if (dir.empty()) return "";
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx.spec",
+                  static_cast<unsigned long long>(key));
+    return dir + name;
+  }
+
+  G4bool ReadCache(const G4String& path, PropertyLoader::Spectrum& spectrum)
+  {
+    G4int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      return false;
+    }
+    const std::size_t size = st.st_size;
+
+    void* data = (size >= sizeof(CacheHeader)) ?
+      mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    const CacheHeader* header = static_cast<const CacheHeader*>(data);
+    const std::size_t n = header->num_entries;
+    const G4bool valid =
+      std::memcmp(header->magic, kCacheMagic, sizeof(kCacheMagic)) == 0 &&
+      header->version == kCacheVersion &&
+      size == sizeof(CacheHeader) + 2 * n * sizeof(G4double);
+
+    if (valid) {
+      const G4double* energies = reinterpret_cast<const G4double*>(header + 1);
+      spectrum.energies.assign(energies, energies + n);
+      spectrum.values.assign(energies + n, energies + 2*n);
+    }
+
+    munmap(data, size);
+    return valid;
+  }
+
+  void WriteCache(const G4String& path, const PropertyLoader::Spectrum& spectrum)
+  {
+    // Written to a temporary file and renamed, so that concurrent jobs
+    // never read a partially written cache.
+    mkdir(CacheDirectory().c_str(), 0755);
+
+    const G4String tmp_path = path + ".tmp" + std::to_string(getpid());
+    std::FILE* file = std::fopen(tmp_path.c_str(), "wb");
+    if (!file) return;
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version = kCacheVersion;
+    header.num_entries = spectrum.energies.size();
+
+    const std::size_t n = spectrum.energies.size();
+    G4bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+      std::fwrite(spectrum.energies.data(), sizeof(G4double), n, file) == n &&
+      std::fwrite(spectrum.values.data(), sizeof(G4double), n, file) == n;
+    ok = (std::fclose(file) == 0) && ok;
+
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0)
+      std::remove(tmp_path.c_str());
+  }
+
+  PropertyLoader::Spectrum Parse(const G4String& path, const std::string& text,
+                                 PropertyLoader::Axis axis,
+                                 G4double axis_unit, G4double value_unit)
+  {
+    std::vector<std::pair<G4double, G4double>> points;
+
+    std::istringstream lines(text);
+    std::string line;
+    G4int line_number = 0;
+
+    while (std::getline(lines, line)) {
+      ++line_number;
+
+      const std::size_t first = line.find_first_not_of(" \t\r");
+      if (first == std::string::npos || line[first] == '#') continue;
+
+      std::replace(line.begin(), line.end(), ',', ' ');
+      std::istringstream fields(line);
+      G4double x, y;
+
+      if (!(fields >> x >> y) || !std::isfinite(x) || !std::isfinite(y) || x <= 0.) {
+        G4ExceptionDescription ed;
+        ed << path << ":" << line_number << ": invalid entry '" << line << "'.";
+        G4Exception("PropertyLoader::Load()", "PropertyLoader",
+                    FatalErrorInArgument, ed);
+        continue;
+      }
+
+      x *= axis_unit;
+      if (axis == PropertyLoader::kWavelength) x = h_Planck * c_light / x;
+      points.emplace_back(x, y * value_unit);
+    }
+
+    if (points.size() < 2) {
+      G4ExceptionDescription ed;
+      ed << path << " contains fewer than two entries.";
+      G4Exception("PropertyLoader::Load()", "PropertyLoader",
+                  FatalErrorInArgument, ed);
+    }
+
+    std::stable_sort(points.begin(), points.end(),
+      [](const std::pair<G4double, G4double>& a,
+         const std::pair<G4double, G4double>& b) { return a.first < b.first; });
+
+    // Average entries with the same energy
+    PropertyLoader::Spectrum spectrum;
+    for (std::size_t i=0; i<points.size(); ) {
+      std::size_t j = i;
+      G4double sum = 0.;
+      while (j < points.size() && points[j].first == points[i].first)
+        sum += points[j++].second;
+      spectrum.energies.push_back(points[i].first);
+      spectrum.values.push_back(sum / (j - i));
+      i = j;
+    }
+
+    return spectrum;
+  }
+
+} // end anonymous namespace
+
+
+G4String PropertyLoader::DataPath(const G4String& filename)
+{
+  const char* dir = std::getenv("G4OPSIM_DATA");
+  return G4String(dir ? dir : G4OPSIM_DATA_DIR) + "/" + filename;
+}
+
+
+PropertyLoader::Spectrum PropertyLoader::Load(const G4String& filename, Axis axis,
+                                              G4double axis_unit, G4double value_unit)
+{
+  const G4String path = DataPath(filename);
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    G4ExceptionDescription ed;
+    ed << "Cannot open data file " << path << ".";
+    G4Exception("PropertyLoader::Load()", "PropertyLoader",
+                FatalErrorInArgument, ed);
+    return Spectrum();
+  }
+
+  const std::string text((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+
+  // The cache key covers both the contents of the file and
+  // the parameters of the conversion to energy
+  std::uint64_t key = Hash(text.data(), text.size());
+  const G4double params[] = {G4double(axis), axis_unit, value_unit};
+  key = Hash(params, sizeof(params), key);
+
+  Spectrum spectrum;
+  const G4String cache_path = CachePath(key);
+
+  if (!cache_path.empty() && ReadCache(cache_path, spectrum)) return spectrum;
+
+  spectrum = Parse(path, text, axis, axis_unit, value_unit);
+  if (!cache_path.empty()) WriteCache(cache_path, spectrum);
+
+  return spectrum;
+}
+
+
+void PropertyLoader::PadWithZeros(Spectrum& spectrum,
+                                  G4double energy_min, G4double energy_max)
+{
+  if (spectrum.energies.empty() || energy_min < spectrum.energies.front()) {
+    spectrum.energies.insert(spectrum.energies.begin(), energy_min);
+    spectrum.values.insert(spectrum.values.begin(), 0.);
+  }
+  if (energy_max > spectrum.energies.back()) {
+    spectrum.energies.push_back(energy_max);
+    spectrum.values.push_back(0.);
+  }
+}
+
+
+void PropertyLoader::AddProperty(G4MaterialPropertiesTable* mpt,
+                                 const G4String& key, const Spectrum& spectrum)
+{
+  // The vectors are copied by the table
+  mpt->AddProperty(key, const_cast<G4double*>(spectrum.energies.data()),
+                   const_cast<G4double*>(spectrum.values.data()),
+                   spectrum.energies.size());
+}
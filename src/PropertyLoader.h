@@ -0,0 +1,55 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | PropertyLoader.h
+//
+//  Loading of tabulated optical properties (spectra) from CSV files in the
+//  data directory. Every line holds an abscissa (photon energy or
+//  wavelength) and a value, separated by a comma or blanks; lines starting
+//  with '#' are comments. Spectra are validated, converted to photon energy
+//  and sorted. The parsed result is cached in a binary file named after a
+//  hash of the CSV contents and the conversion parameters, so that later
+//  jobs map the cache instead of parsing the file again.
+//
+//  The data directory is taken from the G4OPSIM_DATA environment variable,
+//  or else is the one of the source tree. The cache directory is taken from
+//  G4OPSIM_CACHE (an empty value disables the cache), or else is a
+//  subdirectory of the system temporary directory.
+// -----------------------------------------------------------------------------
+
+#ifndef PROPERTY_LOADER_H
+#define PROPERTY_LOADER_H
+
+#include <globals.hh>
+
+#include <vector>
+
+class G4MaterialPropertiesTable;
+
+
+namespace PropertyLoader {
+
+  // Abscissa of the CSV files
+  enum Axis { kEnergy, kWavelength };
+
+  struct Spectrum {
+    std::vector<G4double> energies; // increasing
+    std::vector<G4double> values;
+  };
+
+  // Full path of a file in the data directory
+  G4String DataPath(const G4String& filename);
+
+  // Read a spectrum from the data directory. The abscissa is multiplied by
+  // axis_unit (e.g. eV or nm) and the values by value_unit. Entries with the
+  // same energy are averaged. Invalid files are fatal errors.
+  Spectrum Load(const G4String& filename, Axis axis,
+                G4double axis_unit, G4double value_unit=1.);
+
+  // Extend a spectrum with zero values at the given energies
+  // if they lie outside the tabulated range
+  void PadWithZeros(Spectrum&, G4double energy_min, G4double energy_max);
+
+  void AddProperty(G4MaterialPropertiesTable*, const G4String& key, const Spectrum&);
+
+} // end namespace PropertyLoader
+
+#endif
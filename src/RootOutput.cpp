@@ -0,0 +1,170 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | RootOutput.cpp
+//
+//  Persistency of the event records in a ROOT TTree.
+// -----------------------------------------------------------------------------
+
+#include "RootOutput.h"
+#include "RunFileName.h"
+
+#include <G4GenericMessenger.hh>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TROOT.h>
+#include <Compression.h>
+
+
+RootOutput& RootOutput::Instance()
+{
+  static RootOutput instance;
+  return instance;
+}
+
+
+RootOutput::RootOutput():
+  filename_(""),
+  basket_size_(64000), compression_(4), algorithm_("zlib"),
+  autoflush_(1000), queue_capacity_(256),
+  path_(""), queue_(queue_capacity_), open_(false),
+  file_(nullptr), tree_(nullptr),
+  msg_(nullptr)
+{
+  DefineMessenger();
+}
+
+
+RootOutput::~RootOutput()
+{
+  Close();
+  delete msg_;
+}
+
+
+void RootOutput::DefineMessenger()
+{
+  // The output is handled by the master thread only: commands
+  // do not need to be broadcast to the worker threads.
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/output/",
+                                "Control of the ROOT output.");
+
+  msg_->DeclareProperty("rootFile", filename_,
+                        "Name of the ROOT output file (empty: no output).")
+    .SetParameterName("filename", true)
+    .SetDefaultValue("")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareProperty("basketSize", basket_size_,
+                        "Buffer size (in bytes) of the tree branches.")
+    .SetParameterName("size", false)
+    .SetRange("size>0")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareProperty("compression", compression_,
+                        "Compression level (0: no compression).")
+    .SetParameterName("level", false)
+    .SetRange("level>=0 && level<=9")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareProperty("compressionAlgorithm", algorithm_,
+                        "Compression algorithm.")
+    .SetParameterName("algorithm", false)
+    .SetCandidates("zlib lzma lz4 zstd")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareProperty("autoFlush", autoflush_,
+                        "Number of events between flushes of the tree baskets.")
+    .SetParameterName("entries", false)
+    .SetRange("entries>0")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareProperty("queueSize", queue_capacity_,
+                        "Maximum number of events waiting to be written.")
+    .SetParameterName("events", false)
+    .SetRange("events>0")
+    .SetToBeBroadcasted(false);
+}
+
+
+void RootOutput::Open(G4int run_id)
+{
+  if (open_ || filename_.empty()) return;
+
+  // Only the writer thread touches ROOT objects once the tree is created,
+  // but ROOT still needs to know that other threads exist.
+  ROOT::EnableThreadSafety();
+
+  path_ = RunFileName(filename_, run_id);
+  file_ = TFile::Open(path_.c_str(), "RECREATE");
+  if (!file_ || file_->IsZombie()) {
+    G4ExceptionDescription ed;
+    ed << "Cannot open output file " << path_ << ".";
+    G4Exception("RootOutput::Open()", "RootOutput", FatalException, ed);
+    return;
+  }
+
+  ROOT::RCompressionSetting::EAlgorithm::EValues algorithm =
+    ROOT::RCompressionSetting::EAlgorithm::kZLIB;
+  if      (algorithm_ == "lzma") algorithm = ROOT::RCompressionSetting::EAlgorithm::kLZMA;
+  else if (algorithm_ == "lz4")  algorithm = ROOT::RCompressionSetting::EAlgorithm::kLZ4;
+  else if (algorithm_ == "zstd") algorithm = ROOT::RCompressionSetting::EAlgorithm::kZSTD;
+  file_->SetCompressionSettings(ROOT::CompressionSettings(algorithm, compression_));
+
+  tree_ = new TTree("events", Form("G4OpSim optical hits (run %d)", run_id));
+  tree_->SetDirectory(file_);
+  tree_->SetAutoFlush(autoflush_);
+
+  // One branch per column, fully split
+  const G4int split = 99;
+  tree_->Branch("event_id",      &buffer_.event_id, "event_id/I", basket_size_);
+  tree_->Branch("sensor_id",     &buffer_.sensor_id,     basket_size_, split);
+  tree_->Branch("sensor_counts", &buffer_.sensor_counts, basket_size_, split);
+  tree_->Branch("wvf_sensor_id", &buffer_.wvf_sensor_id, basket_size_, split);
+  tree_->Branch("wvf_time",      &buffer_.wvf_time,      basket_size_, split);
+  tree_->Branch("wvf_counts",    &buffer_.wvf_counts,    basket_size_, split);
+
+  queue_.Reopen(queue_capacity_);
+  writer_ = std::thread(&RootOutput::WriterLoop, this);
+  open_ = true;
+
+  G4cout << "[RootOutput] Writing events to " << path_ << G4endl;
+}
+
+
+void RootOutput::Write(EventRecord&& record)
+{
+  if (!open_) return;
+  queue_.Push(std::move(record));
+}
+
+
+void RootOutput::WriterLoop()
+{
+  EventRecord record;
+  while (queue_.Pop(record)) {
+    std::swap(buffer_, record);
+    tree_->Fill();
+  }
+}
+
+
+void RootOutput::Close()
+{
+  if (!open_) return;
+
+  // Closing the queue lets the writer drain the remaining records and exit
+  queue_.Close();
+  writer_.join();
+
+  file_->cd();
+  tree_->Write();
+  G4cout << "[RootOutput] " << tree_->GetEntries() << " events written to "
+         << path_ << G4endl;
+
+  file_->Close();
+  delete file_;
+  file_ = nullptr;
+  tree_ = nullptr; // owned (and deleted) by the file
+
+  open_ = false;
+}
@@ -0,0 +1,75 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | RootOutput.h
+//
+//  Persistency of the event records in a ROOT TTree. Worker threads hand
+//  over their records through a bounded queue to a dedicated writer thread,
+//  which is the only one that serializes and compresses data or touches the
+//  output file. There is a single instance shared by all threads; the file
+//  is opened and closed by the master run action.
+// -----------------------------------------------------------------------------
+
+#ifndef ROOT_OUTPUT_H
+#define ROOT_OUTPUT_H
+
+#include "EventRecord.h"
+#include "BoundedQueue.h"
+
+#include <globals.hh>
+
+#include <thread>
+
+class TFile;
+class TTree;
+class G4GenericMessenger;
+
+
+class RootOutput
+{
+public:
+  static RootOutput& Instance();
+
+  // Open the output file of a run (see RunFileName.h) and start the writer
+  // thread. Nothing is done if no file name has been configured.
+  void Open(G4int run_id);
+  // Write out all pending records, stop the writer thread and close the file.
+  void Close();
+
+  G4bool IsOpen() const;
+
+  // Queue a record for writing (thread-safe). Waits only if the queue is full.
+  void Write(EventRecord&&);
+
+private:
+  RootOutput();
+  ~RootOutput();
+  RootOutput(const RootOutput&) = delete;
+  RootOutput& operator=(const RootOutput&) = delete;
+
+  void WriterLoop();
+  void DefineMessenger();
+
+private:
+  // Configuration
+  G4String filename_;
+  G4int basket_size_;      // bytes per branch buffer
+  G4int compression_;      // compression level (0-9)
+  G4String algorithm_;     // compression algorithm
+  G4int autoflush_;        // entries between tree flushes
+  G4int queue_capacity_;   // records
+
+  G4String path_; // file written in the current run
+
+  BoundedQueue<EventRecord> queue_;
+  std::thread writer_;
+  G4bool open_;
+
+  TFile* file_;
+  TTree* tree_;
+  EventRecord buffer_; // branch addresses point to its members
+
+  G4GenericMessenger* msg_;
+};
+
+inline G4bool RootOutput::IsOpen() const { return open_; }
+
+#endif
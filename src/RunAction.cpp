@@ -5,18 +5,106 @@
 // -----------------------------------------------------------------------------
 
 #include "RunAction.h"
+#include "SteppingAction.h"
+#include "StackingAction.h"
+#include "PrimaryGeneration.h"
+#include "KillCounters.h"
+#include "PhotonFate.h"
+#include "StepProfiler.h"
+#include "SensorCounts.h"
+#include "RootOutput.h"
+#include "FlatHitOutput.h"
+#include "PathRecordOutput.h"
+#include "VisibilityBuilder.h"
+#include "VisibilityLibrary.h"
+#include "RunSummary.h"
+#include "ParameterSweep.h"
 
 #include <G4Run.hh>
+#include <G4AccumulableManager.hh>
+
+
+RunAction::RunAction(KillCounters* kc, PhotonFate* pf, StepProfiler* sp,
+                     SensorCounts* sc, SteppingAction* sa, StackingAction* st,
+                     PrimaryGeneration* pg):
+  G4UserRunAction(), kill_counters_(kc), photon_fate_(pf), step_profiler_(sp),
+  sensor_counts_(sc), stepping_action_(sa), stacking_action_(st), generator_(pg)
+{
+  kill_counters_->Register();
+  G4AccumulableManager::Instance()->RegisterAccumulable(photon_fate_);
+  G4AccumulableManager::Instance()->RegisterAccumulable(step_profiler_);
+  G4AccumulableManager::Instance()->RegisterAccumulable(sensor_counts_);
+
+  // Instantiate the output managers (and define their macro commands)
+  // as soon as the first run action is created in the master thread.
+  RootOutput::Instance();
+  FlatHitOutput::Instance();
+  PathRecordOutput::Instance();
+  VisibilityBuilder::Instance();
+  VisibilityLibrary::Instance();
+  RunSummary::Instance();
+  ParameterSweep::Instance();
+}
+
+
+RunAction::~RunAction()
+{
+  delete kill_counters_;
+  delete photon_fate_;
+  delete step_profiler_;
+  delete sensor_counts_;
+}
 
 
 void RunAction::BeginOfRunAction(const G4Run* run)
 {
   G4cout << "------------------------------------------------------------\n"
          << "Run ID " << run->GetRunID() << G4endl;
+
+  photon_fate_->Configure();
+  step_profiler_->Configure();
+  G4AccumulableManager::Instance()->Reset();
+
+  if (IsMaster()) {
+    RootOutput::Instance().Open(run->GetRunID());
+    FlatHitOutput::Instance().Open(run->GetRunID());
+    PathRecordOutput::Instance().Open(run->GetRunID());
+    VisibilityBuilder::Instance().Begin();
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  if (generator_) generator_->BeginOfRun();
+  if (stacking_action_) stacking_action_->BeginOfRun();
+  if (stepping_action_) stepping_action_->BeginOfRun();
 }
 
-void RunAction::EndOfRunAction(const G4Run*)
+void RunAction::EndOfRunAction(const G4Run* run)
 {
+  if (stepping_action_) stepping_action_->EndOfRun();
+
+  // Only the threads that process events convert their own timer ticks
+  // (the master receives the worker results in seconds)
+  if (stepping_action_) step_profiler_->Finish();
+
+  // Merge the worker counters into the master ones
+  G4AccumulableManager::Instance()->Merge();
+
+  // In multithreaded mode, the master finishes the run
+  // once all worker threads have processed their events.
+  if (IsMaster()) {
+    RootOutput::Instance().Close();
+    FlatHitOutput::Instance().Close();
+    PathRecordOutput::Instance().Close();
+    VisibilityBuilder::Instance().End();
+    const G4double wall_time =
+      std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start_).count();
+    kill_counters_->Print();
+    kill_counters_->PrintThroughput(wall_time);
+    RunSummary::Instance().Write(run, *kill_counters_, *sensor_counts_, wall_time);
+    photon_fate_->Print();
+    step_profiler_->Report();
+  }
+
   G4cout << "End of run."
          << "------------------------------------------------------------"
          << G4endl;
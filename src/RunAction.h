@@ -9,19 +9,42 @@
 
 #include <G4UserRunAction.hh>
 
+#include <chrono>
+
 class G4Run;
+class SteppingAction;
+class StackingAction;
+class KillCounters;
+class PhotonFate;
+class StepProfiler;
+class SensorCounts;
+class PrimaryGeneration;
 
 
 class RunAction: public G4UserRunAction
 {
 public:
-  RunAction();
+  // The run action takes ownership of the counters. The stepping
+  // and stacking actions and the generator are only defined in worker
+  // threads (or in sequential mode); the master thread passes null pointers.
+  RunAction(KillCounters* kill_counters, PhotonFate* photon_fate,
+            StepProfiler* step_profiler, SensorCounts* sensor_counts,
+            SteppingAction* stepping_action=nullptr,
+            StackingAction* stacking_action=nullptr,
+            PrimaryGeneration* generator=nullptr);
   virtual ~RunAction();
   virtual void BeginOfRunAction(const G4Run*);
   virtual void EndOfRunAction(const G4Run*);
-};
 
-inline RunAction::RunAction() {}
-inline RunAction::~RunAction() {}
+private:
+  KillCounters* kill_counters_;
+  PhotonFate* photon_fate_;
+  StepProfiler* step_profiler_;
+  SensorCounts* sensor_counts_;
+  SteppingAction* stepping_action_;
+  StackingAction* stacking_action_;
+  PrimaryGeneration* generator_;
+  std::chrono::steady_clock::time_point start_; // wall time at beginning of run
+};
 
 #endif
@@ -0,0 +1,33 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | RunFileName.cpp
+//
+//  Name of the file an output writes in a run.
+// -----------------------------------------------------------------------------
+
+#include "RunFileName.h"
+
+#include <set>
+#include <sstream>
+#include <iomanip>
+
+
+G4String RunFileName(const G4String& filename, G4int run_id)
+{
+  static std::set<G4String> used;
+
+  if (used.insert(filename).second) return filename;
+
+  std::ostringstream tag;
+  tag << "_run" << std::setw(4) << std::setfill('0') << run_id;
+
+  const size_t dot = filename.find_last_of('.');
+  const size_t slash = filename.find_last_of('/');
+  G4String name;
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    name = filename + tag.str();
+  else
+    name = filename.substr(0, dot) + tag.str() + filename.substr(dot);
+
+  used.insert(name);
+  return name;
+}
@@ -0,0 +1,20 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | RunFileName.h
+//
+//  Name of the file an output writes in a run. The first run that uses a
+//  configured name writes to it as is; a later run of the same process
+//  configured with the same name gets a run tag before the extension
+//  (hits.flat -> hits_run0003.flat) rather than overwriting the file of
+//  the earlier run, as several /run/beamOn in a macro would otherwise do.
+//  Names are only handed out by the master run action.
+// -----------------------------------------------------------------------------
+
+#ifndef RUN_FILE_NAME_H
+#define RUN_FILE_NAME_H
+
+#include <globals.hh>
+
+
+G4String RunFileName(const G4String& filename, G4int run_id);
+
+#endif
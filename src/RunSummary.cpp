@@ -0,0 +1,103 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | RunSummary.cpp
+//
+//  Machine-readable summary of a run.
+// -----------------------------------------------------------------------------
+
+#include "RunSummary.h"
+#include "KillCounters.h"
+#include "SensorCounts.h"
+
+#include <G4Run.hh>
+#include <G4GenericMessenger.hh>
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include <sys/resource.h>
+
+
+RunSummary& RunSummary::Instance()
+{
+  static RunSummary instance;
+  return instance;
+}
+
+
+RunSummary::RunSummary(): filename_(""), last_(""), msg_(nullptr)
+{
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/output/",
+                                "Control of the output.");
+
+  msg_->DeclareProperty("summaryFile", filename_,
+                        "Name of the JSON run summary (empty: none). "
+                        "It is overwritten at every run.")
+    .SetParameterName("filename", true)
+    .SetDefaultValue("")
+    .SetToBeBroadcasted(false);
+}
+
+
+RunSummary::~RunSummary()
+{
+  delete msg_;
+}
+
+
+G4double RunSummary::PeakResidentMemory()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024. * 1024.); // bytes
+#else
+  return usage.ru_maxrss / 1024.; // kilobytes
+#endif
+}
+
+
+void RunSummary::Write(const G4Run* run, const KillCounters& counters,
+                       const SensorCounts& sensor_counts, G4double wall_time)
+{
+  const G4int num_events = run->GetNumberOfEvent();
+  const G4long num_photons = counters.photons.GetValue();
+  const G4long num_steps = counters.steps.GetValue();
+
+  std::ostringstream out;
+  out.precision(9);
+  out << "{\n"
+      << "  \"run_id\": " << run->GetRunID() << ",\n"
+      << "  \"events\": " << num_events << ",\n"
+      << "  \"wall_time\": " << wall_time << ",\n"
+      << "  \"events_per_second\": "
+      << (wall_time > 0. ? num_events / wall_time : 0.) << ",\n"
+      << "  \"photons\": " << num_photons << ",\n"
+      << "  \"photons_per_second\": "
+      << (wall_time > 0. ? num_photons / wall_time : 0.) << ",\n"
+      << "  \"steps_per_photon\": "
+      << (num_photons > 0 ? G4double(num_steps) / num_photons : 0.) << ",\n"
+      << "  \"peak_rss_mb\": " << PeakResidentMemory() << ",\n"
+      << "  \"sensor_counts\": [";
+
+  const std::vector<G4long>& counts = sensor_counts.GetCounts();
+  for (size_t i=0; i<counts.size(); ++i)
+    out << (i ? ", " : "") << counts[i];
+
+  out << "]\n}\n";
+
+  last_ = out.str();
+  last_.pop_back();
+  std::replace(last_.begin(), last_.end(), '\n', ' ');
+
+  if (filename_.empty()) return;
+
+  std::ofstream file(filename_);
+  if (!file) {
+    G4ExceptionDescription ed;
+    ed << "Cannot open output file " << filename_ << ".";
+    G4Exception("RunSummary::Write()", "RunSummary", JustWarning, ed);
+    return;
+  }
+  file << out.str();
+}
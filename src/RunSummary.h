@@ -0,0 +1,50 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | RunSummary.h
+//
+//  Machine-readable summary of a run (JSON): number of events, wall time,
+//  event and optical-photon throughput, steps per photon, peak resident
+//  memory and number of detected photons per sensor. Written by the master
+//  run action at the end of every run if a file name has been configured,
+//  so that benchmark results can be tracked across releases.
+// -----------------------------------------------------------------------------
+
+#ifndef RUN_SUMMARY_H
+#define RUN_SUMMARY_H
+
+#include <globals.hh>
+
+class G4Run;
+class G4GenericMessenger;
+class KillCounters;
+class SensorCounts;
+
+
+class RunSummary
+{
+public:
+  static RunSummary& Instance();
+
+  // Write the summary of the run (to the file only if a name has been
+  // configured). The counters must have been merged already.
+  void Write(const G4Run*, const KillCounters&, const SensorCounts&,
+             G4double wall_time);
+
+  // Summary of the last run, on a single line
+  const G4String& GetLast() const;
+
+  // Peak resident set size of the process, in MB
+  static G4double PeakResidentMemory();
+
+private:
+  RunSummary();
+  ~RunSummary();
+
+private:
+  G4String filename_;
+  G4String last_;
+  G4GenericMessenger* msg_;
+};
+
+inline const G4String& RunSummary::GetLast() const { return last_; }
+
+#endif
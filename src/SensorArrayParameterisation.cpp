@@ -0,0 +1,33 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | SensorArrayParameterisation.cpp
+//
+//  Row of identical photosensors evenly spaced along the z axis.
+// -----------------------------------------------------------------------------
+
+#include "SensorArrayParameterisation.h"
+
+#include <G4VPhysicalVolume.hh>
+#include <G4ThreeVector.hh>
+
+
+SensorArrayParameterisation::SensorArrayParameterisation(G4int num_sensors,
+                                                         G4double pitch,
+                                                         G4RotationMatrix* rotation):
+  G4VPVParameterisation(),
+  num_sensors_(num_sensors), pitch_(pitch), rotation_(rotation)
+{
+}
+
+
+SensorArrayParameterisation::~SensorArrayParameterisation()
+{
+  delete rotation_;
+}
+
+
+void SensorArrayParameterisation::ComputeTransformation(const G4int copy_number,
+                                                        G4VPhysicalVolume* pv) const
+{
+  pv->SetTranslation(G4ThreeVector(0., 0., copy_number * pitch_ - GetHalfSpan()));
+  pv->SetRotation(rotation_);
+}
@@ -0,0 +1,43 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | SensorArrayParameterisation.h
+//
+//  Row of identical photosensors evenly spaced along the z axis of their
+//  container volume, all with the same rotation. Used to place a whole
+//  array as a single G4PVParameterised.
+// -----------------------------------------------------------------------------
+
+#ifndef SENSOR_ARRAY_PARAMETERISATION_H
+#define SENSOR_ARRAY_PARAMETERISATION_H
+
+#include <G4VPVParameterisation.hh>
+#include <G4RotationMatrix.hh>
+#include <globals.hh>
+
+
+class SensorArrayParameterisation: public G4VPVParameterisation
+{
+public:
+  // The array is centred at the origin of the container. The rotation
+  // (which may be null) is owned by the parameterisation.
+  SensorArrayParameterisation(G4int num_sensors, G4double pitch,
+                              G4RotationMatrix* rotation);
+  virtual ~SensorArrayParameterisation();
+  SensorArrayParameterisation(const SensorArrayParameterisation&) = delete;
+  SensorArrayParameterisation& operator=(const SensorArrayParameterisation&) = delete;
+
+  virtual void ComputeTransformation(const G4int copy_number,
+                                     G4VPhysicalVolume*) const;
+
+  // Distance from the centre of the array to the centre of the last sensor
+  G4double GetHalfSpan() const;
+
+private:
+  G4int num_sensors_;
+  G4double pitch_;
+  G4RotationMatrix* rotation_;
+};
+
+inline G4double SensorArrayParameterisation::GetHalfSpan() const
+{ return 0.5 * (num_sensors_ - 1) * pitch_; }
+
+#endif
@@ -0,0 +1,48 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | SensorCounts.cpp
+//
+//  Number of detected photons per sensor in a run.
+// -----------------------------------------------------------------------------
+
+#include "SensorCounts.h"
+
+#include <algorithm>
+
+
+SensorCounts::SensorCounts(const G4String& name): G4VAccumulable(name)
+{
+}
+
+
+SensorCounts::~SensorCounts()
+{
+}
+
+
+void SensorCounts::Merge(const G4VAccumulable& other)
+{
+  const SensorCounts& worker = static_cast<const SensorCounts&>(other);
+
+  if (worker.counts_.size() > counts_.size())
+    counts_.resize(worker.counts_.size(), 0);
+
+  for (size_t i=0; i<worker.counts_.size(); ++i) counts_[i] += worker.counts_[i];
+}
+
+
+void SensorCounts::Reset()
+{
+  // The number of sensors may change between runs
+  counts_.clear();
+}
+
+
+void SensorCounts::Add(const OpticalHitCollection& hc)
+{
+  if (hc.entries() > counts_.size()) counts_.resize(hc.entries(), 0);
+
+  for (size_t i=0; i<hc.entries(); ++i) {
+    const OpticalHit* hit = hc[i];
+    counts_[hit->GetSensorID()] += hit->GetWaveform().GetTotalCounts();
+  }
+}
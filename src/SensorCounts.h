@@ -0,0 +1,40 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | SensorCounts.h
+//
+//  Number of detected photons per sensor, summed over all the events of a
+//  run. Thread-local accumulable merged into the master at the end of the
+//  run (e.g. for the run summary used by the regression tests).
+// -----------------------------------------------------------------------------
+
+#ifndef SENSOR_COUNTS_H
+#define SENSOR_COUNTS_H
+
+#include "OpticalHit.h"
+
+#include <G4VAccumulable.hh>
+#include <globals.hh>
+
+#include <vector>
+
+
+class SensorCounts: public G4VAccumulable
+{
+public:
+  SensorCounts(const G4String& name="SensorCounts");
+  virtual ~SensorCounts();
+
+  void Merge(const G4VAccumulable&) override;
+  void Reset() override;
+
+  // Add the detections of an event (one hit per sensor)
+  void Add(const OpticalHitCollection&);
+
+  const std::vector<G4long>& GetCounts() const;
+
+private:
+  std::vector<G4long> counts_; // [sensor]
+};
+
+inline const std::vector<G4long>& SensorCounts::GetCounts() const { return counts_; }
+
+#endif
@@ -0,0 +1,283 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | SimulationServer.cpp
+//
+//  Long-lived server mode.
+// -----------------------------------------------------------------------------
+
+#include "SimulationServer.h"
+#include "RunSummary.h"
+
+#include <G4RunManager.hh>
+#include <G4UImanager.hh>
+#include <G4ios.hh>
+#include <Randomize.hh>
+
+#include <sstream>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+
+namespace {
+
+  // Read a line (without the newline) from a file descriptor, buffering
+  // whatever follows it. Returns false at the end of the input.
+  G4bool ReadLine(int fd, std::string& buffer, std::string& line)
+  {
+    size_t end;
+    while ((end = buffer.find('\n')) == std::string::npos) {
+      char chunk[4096];
+      const ssize_t n = read(fd, chunk, sizeof(chunk));
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        if (buffer.empty()) return false;
+        end = buffer.size(); // last line, unterminated
+        buffer += '\n';
+        break;
+      }
+      buffer.append(chunk, n);
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    return true;
+  }
+
+  G4bool WriteLine(int fd, const std::string& line)
+  {
+    const std::string data = line + '\n';
+    size_t written = 0;
+    while (written < data.size()) {
+      const ssize_t n = write(fd, data.data() + written, data.size() - written);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      written += n;
+    }
+    return true;
+  }
+
+  // Decimal integer taking up the whole text
+  G4bool ParseInteger(const G4String& text, long& value)
+  {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtol(text.c_str(), &end, 10);
+    return errno == 0 && *end == '\0';
+  }
+
+  // Seed of a job that does not give one: a hash (FNV-1a) of its ID,
+  // folded to a positive 31-bit value that every CLHEP engine accepts
+  long JobSeed(const G4String& id)
+  {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c: id) {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+    }
+    const long seed = static_cast<long>((hash ^ (hash >> 31)) & 0x7fffffff);
+    return (seed != 0) ? seed : 1;
+  }
+
+} // namespace
+
+
+SimulationServer::SimulationServer(const G4String& socket_path):
+  socket_path_(socket_path), runmgr_(nullptr), reply_fd_(-1), num_jobs_(0)
+{
+  if (socket_path_.empty()) {
+    std::cout.flush();
+    reply_fd_ = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+  }
+}
+
+
+SimulationServer::~SimulationServer()
+{
+  if (reply_fd_ >= 0) {
+    std::cout.flush();
+    dup2(reply_fd_, STDOUT_FILENO);
+    close(reply_fd_);
+  }
+}
+
+
+void SimulationServer::SetOutput(const G4String& filename)
+{
+  const G4bool root = filename.size() > 5 &&
+                      filename.compare(filename.size() - 5, 5, ".root") == 0;
+
+  G4UImanager* UI = G4UImanager::GetUIpointer();
+  UI->ApplyCommand("/G4OpSim/output/rootFile " + (root ? filename : G4String("")));
+  UI->ApplyCommand("/G4OpSim/output/flatFile " + (root ? G4String("") : filename));
+}
+
+
+G4bool SimulationServer::SetSeed(G4int seed)
+{
+  G4Random::setTheSeed(seed);
+  const G4int status =
+    G4UImanager::GetUIpointer()->ApplyCommand("/G4OpSim/random/seed " +
+                                              std::to_string(seed));
+  return status == fCommandSucceeded;
+}
+
+
+G4bool SimulationServer::Serve(G4RunManager* runmgr)
+{
+  runmgr_ = runmgr;
+
+  // A client disconnecting before its reply must not kill the server
+  std::signal(SIGPIPE, SIG_IGN);
+
+  if (reply_fd_ >= 0) {
+    Session(STDIN_FILENO, reply_fd_);
+    return true;
+  }
+
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+
+  if (socket_path_.size() >= sizeof(address.sun_path)) {
+    G4ExceptionDescription ed;
+    ed << "Socket path " << socket_path_ << " is too long.";
+    G4Exception("SimulationServer::Serve()", "SimulationServer", JustWarning, ed);
+    return false;
+  }
+  std::strcpy(address.sun_path, socket_path_.c_str());
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(socket_path_.c_str()); // left behind by a previous server
+  if (fd < 0 ||
+      bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+      listen(fd, 8) < 0) {
+    G4ExceptionDescription ed;
+    ed << "Cannot listen on socket " << socket_path_ << ": " << std::strerror(errno);
+    G4Exception("SimulationServer::Serve()", "SimulationServer", JustWarning, ed);
+    if (fd >= 0) close(fd);
+    return false;
+  }
+
+  G4cout << "Simulation server listening on " << socket_path_ << G4endl;
+
+  G4bool serving = true;
+  while (serving) {
+    const int client = accept(fd, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    serving = Session(client, client);
+    close(client);
+  }
+
+  close(fd);
+  unlink(socket_path_.c_str());
+
+  G4cout << "Simulation server stopped after " << num_jobs_ << " jobs" << G4endl;
+  return true;
+}
+
+
+G4bool SimulationServer::Session(int in, int out)
+{
+  std::string buffer, line;
+  G4bool end_session = false, shutdown = false;
+
+  while (!end_session && ReadLine(in, buffer, line)) {
+    // Blank lines and comments get no reply
+    const size_t first = line.find_first_not_of(" \t");
+    if (first == std::string::npos || line[first] == '#') continue;
+
+    const G4String reply = Process(line.substr(first), end_session, shutdown);
+    if (!WriteLine(out, reply)) break;
+  }
+
+  return !shutdown;
+}
+
+
+G4String SimulationServer::Process(const G4String& line,
+                                   G4bool& end_session, G4bool& shutdown)
+{
+  if (line[0] == '/') {
+    const G4int status = G4UImanager::GetUIpointer()->ApplyCommand(line);
+    if (status == fCommandSucceeded) return "ok";
+    return "error command failed with status " + std::to_string(status);
+  }
+
+  std::istringstream ss(line);
+  G4String keyword, arguments;
+  ss >> keyword;
+  std::getline(ss, arguments);
+
+  if (keyword == "run") return RunJob(arguments);
+
+  if (keyword == "quit" || keyword == "shutdown") {
+    end_session = true;
+    shutdown = (keyword == "shutdown");
+    return "bye";
+  }
+
+  return "error unknown request '" + keyword + "'";
+}
+
+
+G4String SimulationServer::RunJob(const G4String& arguments)
+{
+  G4String id = "job" + std::to_string(num_jobs_);
+  G4String events, seed_text, output, macro;
+
+  std::istringstream ss(arguments);
+  G4String token;
+  while (ss >> token) {
+    const size_t eq = token.find('=');
+    const G4String key   = token.substr(0, eq);
+    const G4String value = (eq == std::string::npos) ? "" : token.substr(eq + 1);
+
+    if      (key == "id")     id = value;
+    else if (key == "events") events = value;
+    else if (key == "seed")   seed_text = value;
+    else if (key == "output") output = value;
+    else if (key == "macro")  macro = value;
+    else return "error " + id + " unknown job parameter '" + key + "'";
+  }
+
+  long num_events = 0;
+  if (events.empty()) return "error " + id + " no events requested";
+  if (!ParseInteger(events, num_events) || num_events <= 0 || num_events > INT_MAX)
+    return "error " + id + " invalid number of events '" + events + "'";
+
+  // Every job starts from a known seed, so that its result does not depend
+  // on the jobs run before it by the same server
+  long seed = JobSeed(id);
+  if (!seed_text.empty() &&
+      (!ParseInteger(seed_text, seed) || seed <= 0 || seed > INT_MAX))
+    return "error " + id + " invalid seed '" + seed_text + "'";
+
+  if (!SetSeed(static_cast<G4int>(seed)))
+    return "error " + id + " cannot set seed " + std::to_string(seed);
+  SetOutput(output);
+
+  if (!macro.empty()) {
+    const G4int status =
+      G4UImanager::GetUIpointer()->ApplyCommand("/control/execute " + macro);
+    if (status != fCommandSucceeded)
+      return "error " + id + " cannot execute macro " + macro;
+  }
+
+  runmgr_->BeamOn(static_cast<G4int>(num_events));
+  ++num_jobs_;
+
+  return "done " + id + " " + RunSummary::Instance().GetLast();
+}
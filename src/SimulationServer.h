@@ -0,0 +1,69 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | SimulationServer.h
+//
+//  Long-lived server mode: the run manager is initialized once and then
+//  runs the jobs it receives, back to back, over a line protocol read from
+//  standard input or from the clients of a local UNIX socket. One reply
+//  line is sent for every request line:
+//
+//    /any/ui/command                      ->  ok | error <message>
+//    run events=<n> [id=<name>] [seed=<seed>] [output=<file>] [macro=<file>]
+//                                         ->  done <id> <JSON run summary>
+//                                           | error <id> <message>
+//    quit                                 ->  bye (ends the session)
+//    shutdown                             ->  bye (stops the server)
+//
+//  UI commands and macros configure the source (and anything else) for the
+//  next jobs. A job without a seed (a positive int) is seeded from a
+//  hash of its ID, never from the random state left by the previous job;
+//  the default ID is job<n>, n being the number of jobs run before. The
+//  hits output file of a job is ROOT if named *.root and flat columnar
+//  otherwise; jobs without one write no hits. A job naming the output file
+//  of an earlier job writes <name>_run<NNNN>.<ext> instead (see
+//  RunFileName.h).
+// -----------------------------------------------------------------------------
+
+#ifndef SIMULATION_SERVER_H
+#define SIMULATION_SERVER_H
+
+#include <globals.hh>
+
+class G4RunManager;
+
+
+class SimulationServer
+{
+public:
+  // Requests are read from standard input if no socket path is given.
+  // In that case the replies are the only thing written to standard
+  // output from then on: everything else is sent to standard error (so
+  // the server should be created before the run manager).
+  SimulationServer(const G4String& socket_path="");
+  ~SimulationServer();
+
+  // Serve requests from standard input or from the clients of the UNIX
+  // socket, one at a time, until shut down. The run manager must have
+  // been initialized. Returns false if the socket could not be set up.
+  G4bool Serve(G4RunManager*);
+
+  // Select the hits output file (empty: no output)
+  static void SetOutput(const G4String& filename);
+  // Seed the random engine and the counter-based streams (whose run seed
+  // is a G4int, hence the type). Returns false if the seed was not set.
+  static G4bool SetSeed(G4int seed);
+
+private:
+  // Serve one session. Returns false if the server must stop.
+  G4bool Session(int in, int out);
+  // Process one request line and return its reply
+  G4String Process(const G4String& line, G4bool& end_session, G4bool& shutdown);
+  G4String RunJob(const G4String& arguments);
+
+private:
+  G4String socket_path_;
+  G4RunManager* runmgr_;
+  int reply_fd_; // standard output, in stdin mode
+  G4int num_jobs_;
+};
+
+#endif
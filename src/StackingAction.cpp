@@ -0,0 +1,164 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | StackingAction.cpp
+//
+//  User stacking action class.
+// -----------------------------------------------------------------------------
+
+#include "StackingAction.h"
+#include "KillCounters.h"
+#include "UniformPropertyVector.h"
+#include "PhotonPath.h"
+#include "PathRecordOutput.h"
+
+#include <G4Track.hh>
+#include <G4OpticalPhoton.hh>
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4LogicalSkinSurface.hh>
+#include <G4OpticalSurface.hh>
+#include <G4Material.hh>
+#include <G4MaterialPropertiesTable.hh>
+#include <G4GenericMessenger.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicalConstants.hh>
+
+#include <algorithm>
+#include <vector>
+#include <utility>
+
+
+StackingAction::StackingAction(KillCounters* counters):
+  G4UserStackingAction(),
+  opticalphoton_(G4OpticalPhoton::Definition()),
+  counters_(counters),
+  kill_undetectable_(true), max_wls_abslength_(10.*m), kill_radius_(0.),
+  record_paths_(false),
+  efficiency_min_(0.), efficiency_max_(DBL_MAX), wls_abslength_(nullptr),
+  msg_(nullptr)
+{
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/stacking/",
+                                "Control of the stacking action.");
+
+  msg_->DeclareProperty("killUndetectable", kill_undetectable_,
+                        "Kill photons outside the sensor efficiency band "
+                        "that cannot be absorbed by the WLS plate.");
+
+  msg_->DeclarePropertyWithUnit("maxWLSAbsLength", "m", max_wls_abslength_,
+                                "Photons with a longer WLS absorption length "
+                                "are considered not absorbable.")
+    .SetParameterName("length", false)
+    .SetRange("length>0.");
+
+  msg_->DeclarePropertyWithUnit("killRadius", "cm", kill_radius_,
+                                "Radius of the kill region around the centre "
+                                "of the plate (0: disabled).")
+    .SetParameterName("radius", false)
+    .SetRange("radius>=0.");
+}
+
+
+StackingAction::~StackingAction()
+{
+  delete wls_abslength_;
+  delete msg_;
+}
+
+
+void StackingAction::BeginOfRun()
+{
+  // The output is opened by the master run action before the workers
+  // start their runs
+  record_paths_ = PathRecordOutput::Instance().IsOpen();
+
+  // Band of the sensor photon-detection efficiency
+  efficiency_min_ = 0.;
+  efficiency_max_ = DBL_MAX;
+
+  G4LogicalVolume* sensarea =
+    G4LogicalVolumeStore::GetInstance()->GetVolume("PHOTOSENSOR_SENSAREA", false);
+  G4LogicalSkinSurface* skin =
+    sensarea ? G4LogicalSkinSurface::GetSurface(sensarea) : nullptr;
+  G4OpticalSurface* surface =
+    skin ? dynamic_cast<G4OpticalSurface*>(skin->GetSurfaceProperty()) : nullptr;
+  G4MaterialPropertiesTable* surface_mpt =
+    surface ? surface->GetMaterialPropertiesTable() : nullptr;
+  G4MaterialPropertyVector* efficiency =
+    surface_mpt ? surface_mpt->GetProperty("EFFICIENCY") : nullptr;
+
+  if (efficiency) {
+    // The table is not necessarily sorted in energy
+    std::vector<std::pair<G4double, G4double>> nodes;
+    for (size_t i=0; i<efficiency->GetVectorLength(); ++i)
+      nodes.emplace_back(efficiency->Energy(i), (*efficiency)[i]);
+    std::sort(nodes.begin(), nodes.end());
+
+    size_t first = nodes.size(), last = 0;
+    for (size_t i=0; i<nodes.size(); ++i) {
+      if (nodes[i].second <= 0.) continue;
+      first = std::min(first, i);
+      last = i;
+    }
+
+    // The interpolated efficiency is non-zero up to the zero nodes next to
+    // the outermost non-zero ones, and beyond the table if an edge value
+    // is non-zero (the edge values extend past the table).
+    if (first < nodes.size()) {
+      efficiency_min_ = (first > 0) ? nodes[first-1].first : 0.;
+      efficiency_max_ = (last+1 < nodes.size()) ? nodes[last+1].first : DBL_MAX;
+    }
+    else {
+      efficiency_min_ = DBL_MAX;
+      efficiency_max_ = 0.;
+    }
+  }
+  else {
+    G4Exception("StackingAction::BeginOfRun()", "StackingAction", JustWarning,
+                "Sensor EFFICIENCY not found: no photon is killed for its energy.");
+  }
+
+  // Wavelength-shifting absorption of the plate
+  G4LogicalVolume* plate =
+    G4LogicalVolumeStore::GetInstance()->GetVolume("WLS_PLATE", false);
+  G4MaterialPropertiesTable* plate_mpt =
+    plate ? plate->GetMaterial()->GetMaterialPropertiesTable() : nullptr;
+  G4MaterialPropertyVector* wls_abslength =
+    plate_mpt ? plate_mpt->GetProperty("WLSABSLENGTH") : nullptr;
+
+  delete wls_abslength_;
+  wls_abslength_ = wls_abslength ? new UniformPropertyVector(*wls_abslength) : nullptr;
+}
+
+
+G4bool StackingAction::IsDetectable(G4double energy) const
+{
+  if (energy >= efficiency_min_ && energy <= efficiency_max_) return true;
+
+  // As in the WLS process, energies outside the table take the edge values
+  return wls_abslength_ && wls_abslength_->Value(energy) < max_wls_abslength_;
+}
+
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  if (track->GetDefinition() != opticalphoton_) return fUrgent;
+
+  counters_->photons += 1;
+
+  if (kill_radius_ > 0. && track->GetPosition().mag2() > kill_radius_*kill_radius_) {
+    counters_->outside += 1;
+    return fKill;
+  }
+
+  if (kill_undetectable_ && !IsDetectable(track->GetKineticEnergy())) {
+    counters_->undetectable += 1;
+    return fKill;
+  }
+
+  // The path must exist before the first step: the boundary process may
+  // detect the photon in it, before the stepping action is invoked.
+  // Photons re-emitted by WLS already carry the one of the absorbed photon.
+  if (record_paths_ && !track->GetUserInformation())
+    track->SetUserInformation(new PhotonPath(h_Planck * c_light / track->GetKineticEnergy()));
+
+  return fUrgent;
+}
@@ -0,0 +1,60 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | StackingAction.h
+//
+//  User stacking action class. Kills optical photons that cannot produce
+//  a hit before they are tracked: those with an energy outside the band
+//  of the sensor EFFICIENCY that cannot be absorbed either by the WLS
+//  plate (WLSABSLENGTH), and, optionally, those created outside a sphere
+//  around the plate (see also the kill region of the stepping action).
+//  If photon paths are recorded, the photons that are kept get their
+//  PhotonPath here, before their first step.
+// -----------------------------------------------------------------------------
+
+#ifndef STACKING_ACTION_H
+#define STACKING_ACTION_H
+
+#include <G4UserStackingAction.hh>
+#include <globals.hh>
+
+class G4ParticleDefinition;
+class UniformPropertyVector;
+class G4GenericMessenger;
+class KillCounters;
+
+
+class StackingAction: public G4UserStackingAction
+{
+public:
+  StackingAction(KillCounters*);
+  virtual ~StackingAction();
+
+  virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);
+
+  // Read the viability criteria from the material property tables.
+  // Invoked by the run action at the beginning of every run.
+  void BeginOfRun();
+
+  // Whether a photon of the given energy can produce a hit
+  G4bool IsDetectable(G4double energy) const;
+
+  // Radius of the kill region around the centre of the plate (0: none)
+  G4double GetKillRadius() const;
+
+private:
+  const G4ParticleDefinition* opticalphoton_;
+  KillCounters* counters_;
+
+  G4bool kill_undetectable_;
+  G4double max_wls_abslength_; // longer absorption lengths are not viable
+  G4double kill_radius_;       // 0: no kill region
+  G4bool record_paths_;
+
+  G4double efficiency_min_, efficiency_max_; // band of non-zero EFFICIENCY
+  UniformPropertyVector* wls_abslength_;
+
+  G4GenericMessenger* msg_;
+};
+
+inline G4double StackingAction::GetKillRadius() const { return kill_radius_; }
+
+#endif
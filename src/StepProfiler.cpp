@@ -0,0 +1,238 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | StepProfiler.cpp
+//
+//  Attribution of step counts and wall time to (volume, process) pairs.
+// -----------------------------------------------------------------------------
+
+#include "StepProfiler.h"
+
+#include <G4VProcess.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4GenericMessenger.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+
+namespace {
+
+  struct Row {
+    G4String volume, process;
+    G4long steps, sampled;
+    G4double time; // estimated total time (s)
+  };
+
+  G4String Escape(const G4String& s)
+  {
+    G4String out;
+    for (char c: s) {
+      if (c == '"' || c == '\\') out += '\\';
+      out += c;
+    }
+    return out;
+  }
+
+  // Entries of the profiler with at least one step, sorted by estimated
+  // time (extrapolated from the timed steps) and number of steps
+  template <typename Entries>
+  std::vector<Row> Rows(const Entries& entries, G4int num_volumes,
+                        const std::vector<G4String>& process_names)
+  {
+    std::vector<G4String> volume_names(num_volumes);
+    for (const G4LogicalVolume* lv: *G4LogicalVolumeStore::GetInstance())
+      if (lv->GetInstanceID() < num_volumes)
+        volume_names[lv->GetInstanceID()] = lv->GetName();
+
+    std::vector<Row> rows;
+    for (size_t slot=0; slot<process_names.size(); ++slot) {
+      for (G4int v=0; v<num_volumes; ++v) {
+        const auto& entry = entries[slot * num_volumes + v];
+        if (entry.steps == 0) continue;
+        const G4double time =
+          entry.sampled ? entry.time * entry.steps / entry.sampled : 0.;
+        rows.push_back({volume_names[v], process_names[slot],
+                        entry.steps, entry.sampled, time});
+      }
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+      return (a.time != b.time) ? a.time > b.time : a.steps > b.steps;
+    });
+
+    return rows;
+  }
+
+} // end namespace
+
+
+StepProfiler::StepProfiler(const G4String& name):
+  G4VAccumulable(name),
+  period_(0), filename_("step_profile.json"),
+  num_volumes_(0),
+  countdown_(0), mark_(0), start_ticks_(0),
+  msg_(nullptr)
+{
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/profiler/",
+                                "Control of the step profiler.");
+
+  msg_->DeclareProperty("period", period_,
+                        "Time one in every N steps (0 disables the profiler).")
+    .SetParameterName("N", false)
+    .SetRange("N>=0");
+
+  msg_->DeclareProperty("output", filename_,
+                        "Name of the JSON report (empty: none).")
+    .SetParameterName("filename", true)
+    .SetDefaultValue("");
+}
+
+
+StepProfiler::~StepProfiler()
+{
+  delete msg_;
+}
+
+
+void StepProfiler::Configure()
+{
+  num_volumes_ = 0;
+  for (const G4LogicalVolume* lv: *G4LogicalVolumeStore::GetInstance())
+    num_volumes_ = std::max(num_volumes_, lv->GetInstanceID() + 1);
+
+  processes_.clear();
+  process_names_.clear();
+  entries_.clear();
+
+  countdown_ = period_;
+  mark_ = 0;
+
+  start_ticks_ = ReadTimer();
+  start_time_ = std::chrono::steady_clock::now();
+}
+
+
+void StepProfiler::Finish()
+{
+  const G4double elapsed =
+    std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start_time_).count();
+  const G4long ticks = ReadTimer() - start_ticks_;
+  if (ticks <= 0 || elapsed <= 0.) return;
+
+  const G4double seconds_per_tick = elapsed / ticks;
+  for (Entry& entry: entries_) entry.time *= seconds_per_tick;
+}
+
+
+G4int StepProfiler::ProcessSlot(const G4VProcess* process)
+{
+  // Few processes take part in the simulation: a linear search is enough
+  for (size_t slot=0; slot<processes_.size(); ++slot)
+    if (processes_[slot] == process) return slot;
+
+  processes_.push_back(process);
+  process_names_.push_back(process ? process->GetProcessName() : G4String("none"));
+  entries_.resize(entries_.size() + num_volumes_, Entry());
+  return processes_.size() - 1;
+}
+
+
+G4int StepProfiler::ProcessSlot(const G4String& name)
+{
+  auto it = std::find(process_names_.begin(), process_names_.end(), name);
+  if (it != process_names_.end()) return it - process_names_.begin();
+
+  processes_.push_back(nullptr);
+  process_names_.push_back(name);
+  entries_.resize(entries_.size() + num_volumes_, Entry());
+  return processes_.size() - 1;
+}
+
+
+void StepProfiler::Merge(const G4VAccumulable& other)
+{
+  const StepProfiler& worker = static_cast<const StepProfiler&>(other);
+
+  // Processes are matched by name, as every thread has its own instances
+  for (size_t wslot=0; wslot<worker.process_names_.size(); ++wslot) {
+    const G4int slot = ProcessSlot(worker.process_names_[wslot]);
+    for (G4int v=0; v<std::min(num_volumes_, worker.num_volumes_); ++v) {
+      const Entry& from = worker.entries_[wslot * worker.num_volumes_ + v];
+      Entry& to = GetEntry(v, slot);
+      to.steps   += from.steps;
+      to.sampled += from.sampled;
+      to.time    += from.time;
+    }
+  }
+}
+
+
+void StepProfiler::Reset()
+{
+  std::fill(entries_.begin(), entries_.end(), Entry());
+}
+
+
+void StepProfiler::Report() const
+{
+  if (!IsEnabled()) return;
+
+  const std::vector<Row> rows = Rows(entries_, num_volumes_, process_names_);
+
+  G4double total_time = 0.;
+  G4long total_steps = 0;
+  for (const Row& row: rows) {
+    total_time  += row.time;
+    total_steps += row.steps;
+  }
+
+  const std::streamsize precision = G4cout.precision();
+
+  G4cout << "Step profile (1 in " << period_ << " steps timed, "
+         << total_steps << " steps, " << total_time << " s estimated):\n"
+         << "  " << std::left << std::setw(24) << "volume"
+         << std::setw(20) << "process" << std::right
+         << std::setw(14) << "steps" << std::setw(12) << "time [s]"
+         << std::setw(8) << "%" << std::setw(12) << "ns/step" << '\n';
+
+  for (const Row& row: rows) {
+    G4cout << "  " << std::left << std::setw(24) << row.volume
+           << std::setw(20) << row.process << std::right
+           << std::setw(14) << row.steps
+           << std::setw(12) << std::setprecision(4) << row.time
+           << std::setw(8) << std::fixed << std::setprecision(1)
+           << (total_time > 0. ? 100. * row.time / total_time : 0.)
+           << std::setw(12) << 1.E9 * row.time / row.steps
+           << std::defaultfloat << '\n';
+  }
+  G4cout << std::setprecision(precision) << G4endl;
+
+  if (!filename_.empty()) WriteJSON(filename_);
+}
+
+
+void StepProfiler::WriteJSON(const G4String& filename) const
+{
+  std::ofstream out(filename);
+  if (!out) {
+    G4ExceptionDescription ed;
+    ed << "Cannot open output file " << filename << ".";
+    G4Exception("StepProfiler::WriteJSON()", "StepProfiler", JustWarning, ed);
+    return;
+  }
+
+  const std::vector<Row> rows = Rows(entries_, num_volumes_, process_names_);
+
+  out << "{\n  \"period\": " << period_ << ",\n  \"entries\": [";
+  out << std::setprecision(9);
+  for (size_t i=0; i<rows.size(); ++i) {
+    const Row& row = rows[i];
+    out << (i ? ",\n" : "\n")
+        << "    {\"volume\": \"" << Escape(row.volume)
+        << "\", \"process\": \"" << Escape(row.process)
+        << "\", \"steps\": " << row.steps
+        << ", \"sampled\": " << row.sampled
+        << ", \"time\": " << row.time << "}";
+  }
+  out << "\n  ]\n}\n";
+}
@@ -0,0 +1,132 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | StepProfiler.h
+//
+//  Attribution of step counts and wall time to (logical volume, process)
+//  pairs. Every step is counted; one in every N steps is timed with the
+//  time-stamp counter of the CPU (the interval between two consecutive
+//  invocations of the stepping action). The first step of a track is
+//  never timed: its interval also covers the end of the previous track,
+//  the stacking of secondaries and possibly a whole event boundary
+//  (output, next primaries). Thread-local accumulable merged
+//  into the master, which prints a sorted table and writes a JSON file at
+//  the end of the run.
+// -----------------------------------------------------------------------------
+
+#ifndef STEP_PROFILER_H
+#define STEP_PROFILER_H
+
+#include <G4VAccumulable.hh>
+#include <G4Step.hh>
+#include <G4Track.hh>
+#include <G4LogicalVolume.hh>
+#include <globals.hh>
+
+#include <vector>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+class G4VProcess;
+class G4GenericMessenger;
+
+
+class StepProfiler: public G4VAccumulable
+{
+public:
+  StepProfiler(const G4String& name="StepProfiler");
+  virtual ~StepProfiler();
+
+  // Size the tables for the current geometry and start the timers.
+  // Invoked at the beginning of every run in all threads.
+  void Configure();
+  // Convert the timer ticks of this thread to seconds. Invoked at the end
+  // of every run in all threads, before merging.
+  void Finish();
+
+  void Merge(const G4VAccumulable&) override;
+  void Reset() override;
+
+  G4bool IsEnabled() const;
+
+  // Attribute the step (just completed) to its pre-step volume and to the
+  // process that limited it
+  void Sample(const G4Step*);
+
+  // Print the (merged) table and write the JSON file
+  void Report() const;
+
+private:
+  struct Entry {
+    G4long steps;   // steps counted
+    G4long sampled; // steps timed
+    G4double time;  // time of the timed steps (ticks until Finish(), then s)
+  };
+
+  static G4long ReadTimer();
+
+  G4int ProcessSlot(const G4VProcess*);
+  G4int ProcessSlot(const G4String&);
+  Entry& GetEntry(G4int volume, G4int slot);
+
+  void WriteJSON(const G4String&) const;
+
+private:
+  G4int period_;      // one in every period_ steps is timed (0: disabled)
+  G4String filename_; // JSON output (empty: none)
+
+  G4int num_volumes_; // volumes indexed by their instance ID
+  std::vector<const G4VProcess*> processes_; // slot -> process (this thread)
+  std::vector<G4String> process_names_;      // slot -> process name
+  std::vector<Entry> entries_;               // [slot][volume]
+
+  G4int countdown_;
+  G4long mark_; // timer at the previous step (0: none)
+
+  // Calibration of the timer against the steady clock
+  G4long start_ticks_;
+  std::chrono::steady_clock::time_point start_time_;
+
+  G4GenericMessenger* msg_;
+};
+
+inline G4bool StepProfiler::IsEnabled() const { return period_ > 0; }
+
+inline G4long StepProfiler::ReadTimer()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+inline StepProfiler::Entry& StepProfiler::GetEntry(G4int volume, G4int slot)
+{ return entries_[slot * num_volumes_ + volume]; }
+
+inline void StepProfiler::Sample(const G4Step* step)
+{
+  const G4int volume =
+    step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume()->GetInstanceID();
+  if (volume >= num_volumes_) return;
+
+  Entry& entry =
+    GetEntry(volume, ProcessSlot(step->GetPostStepPoint()->GetProcessDefinedStep()));
+  ++entry.steps;
+
+  // The timer is read at the step before a timed one (or at every step if
+  // all of them are timed) and at the timed one.
+  if (--countdown_ == 0) {
+    const G4long now = ReadTimer();
+    if (mark_ > 0 && step->GetTrack()->GetCurrentStepNumber() > 1) {
+      entry.time += G4double(now - mark_);
+      ++entry.sampled;
+    }
+    countdown_ = period_;
+    mark_ = (period_ == 1) ? now : 0;
+  }
+  if (countdown_ == 1 && period_ > 1) mark_ = ReadTimer();
+}
+
+#endif
@@ -5,90 +5,260 @@
 // -----------------------------------------------------------------------------
 
 #include "SteppingAction.h"
+#include "StackingAction.h"
+#include "KillCounters.h"
+#include "PhotonFate.h"
+#include "StepProfiler.h"
+#include "PhotonPath.h"
+#include "PathRecordOutput.h"
 
 #include <G4Step.hh>
-#include <G4SteppingManager.hh>
-#include <G4ProcessManager.hh>
 #include <G4OpticalPhoton.hh>
-#include <G4OpBoundaryProcess.hh>
 #include <G4VPhysicalVolume.hh>
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4GenericMessenger.hh>
+#include <G4ProcessManager.hh>
+#include <G4VProcess.hh>
+#include <G4OpBoundaryProcess.hh>
+#include <G4OpProcessSubType.hh>
 
 
-SteppingAction::SteppingAction():
-  G4UserSteppingAction(), counter(0)
+SteppingAction::SteppingAction(const StackingAction* stacking_action,
+                               KillCounters* counters,
+                               PhotonFate* photon_fate,
+                               StepProfiler* step_profiler):
+  G4UserSteppingAction(),
+  opticalphoton_(G4OpticalPhoton::Definition()),
+  world_logic_vol_(nullptr), envelope_logic_vol_(nullptr),
+  boundary_(nullptr),
+  record_paths_(false), foil_logic_vol_(),
+  stacking_action_(stacking_action), kill_counters_(counters), kill_radius2_(0.),
+  photon_fate_(photon_fate), step_profiler_(step_profiler),
+  trace_period_(0), trace_size_(1000),
+  trace_countdown_(0), trace_count_(0),
+  msg_(nullptr)
 {
-  G4cout << "SteppingAction::SteppingAction" << G4endl;
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/stepping/",
+                                "Control of the stepping action.");
+
+  msg_->DeclareProperty("traceEvery", trace_period_,
+                        "Store one in every N optical-photon steps "
+                        "in the trace buffer (0 disables the trace).")
+    .SetParameterName("N", false)
+    .SetRange("N>=0");
+
+  msg_->DeclareProperty("traceSize", trace_size_,
+                        "Number of entries of the trace ring buffer.")
+    .SetParameterName("size", false)
+    .SetRange("size>0");
 }
 
 
 SteppingAction::~SteppingAction()
 {
-  G4cout << "SteppingAction::~SteppingAction" << G4endl;
-  G4cout << "counter: " << counter << G4endl;
+  delete msg_;
+}
+
+
+void SteppingAction::BeginOfRun()
+{
+  // Volumes are identified through their pointers, resolved here once
+  // instead of comparing names on every step.
+  world_logic_vol_ =
+    G4LogicalVolumeStore::GetInstance()->GetVolume("WORLD", false);
+  envelope_logic_vol_ =
+    G4LogicalVolumeStore::GetInstance()->GetVolume("ENVELOPE", false);
+
+  // The output is opened by the master run action before the workers
+  // start their runs
+  record_paths_ = PathRecordOutput::Instance().IsOpen();
+  foil_logic_vol_[PathRecordFormat::kBottomFoil] =
+    G4LogicalVolumeStore::GetInstance()->GetVolume("REF_BOTTOM_FOIL", false);
+  foil_logic_vol_[PathRecordFormat::kSideFoil] =
+    G4LogicalVolumeStore::GetInstance()->GetVolume("REF_SIDE_FOIL", false);
+
+  kill_radius2_ = 0.;
+  if (stacking_action_ && kill_counters_) {
+    const G4double radius = stacking_action_->GetKillRadius();
+    kill_radius2_ = radius * radius;
+  }
+
+  // The boundary process is thread-local, like this action
+  boundary_ = nullptr;
+  const G4ProcessVector* processes = opticalphoton_->GetProcessManager()->GetProcessList();
+  for (size_t i=0; i<processes->size(); ++i) {
+    G4OpBoundaryProcess* boundary = dynamic_cast<G4OpBoundaryProcess*>((*processes)[i]);
+    if (boundary) boundary_ = boundary;
+  }
+
+  trace_.clear();
+  if (trace_period_ > 0) trace_.reserve(trace_size_);
+  trace_countdown_ = trace_period_;
+  trace_count_ = 0;
 }
 
 
 void SteppingAction::UserSteppingAction(const G4Step* step)
 {
-  if (step->GetTrack()->GetParentID() == 0) return;
+  if (step_profiler_ && step_profiler_->IsEnabled()) step_profiler_->Sample(step);
 
-  G4ParticleDefinition* pdef = step->GetTrack()->GetDefinition();
+  G4Track* track = step->GetTrack();
 
   //Check whether the track is an optical photon
-  if (pdef != G4OpticalPhoton::Definition()) return;
+  if (track->GetDefinition() != opticalphoton_) return;
 
-  auto step_number = step->GetTrack()->GetCurrentStepNumber();
-  auto volume_name = step->GetTrack()->GetVolume()->GetName();
+  const G4StepPoint* post = step->GetPostStepPoint();
+  const G4LogicalVolume* pre_volume =
+    step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume();
+  // Null if the photon left the world
+  const G4LogicalVolume* post_volume =
+    post->GetPhysicalVolume() ? post->GetPhysicalVolume()->GetLogicalVolume() : nullptr;
 
-  G4cout << "step_number: " << step_number << ", volume_name: " << volume_name << G4endl;
+  if (photon_fate_) {
+    photon_fate_->AddStep(pre_volume);
+    if (boundary_ && post_volume && post->GetStepStatus() == fGeomBoundary)
+      photon_fate_->AddBoundary(post_volume, boundary_->GetStatus());
+  }
 
-  if (step_number==3 && volume_name=="WLS_PLATE") ++counter;
+  if (record_paths_) RecordPath(step, post_volume);
 
-  /*
-  // example of information one can access about optical photons
+  if (kill_counters_) {
+    kill_counters_->steps += 1;
 
-  G4Track* track = step->GetTrack();
-  G4int pid = track->GetParentID();
-  G4int tid = track->GetTrackID();
-  G4StepPoint* point1 = step->GetPreStepPoint();
-  G4StepPoint* point2 = step->GetPostStepPoint();
-  G4TouchableHandle touch1 = point1->GetTouchableHandle();
-  G4TouchableHandle touch2 = point2->GetTouchableHandle();
-  G4String vol1name = touch1->GetVolume()->GetName();
-  G4String vol2name = touch2->GetVolume()->GetName();
-
-  G4String proc_name = step->GetPostStepPoint()->GetProcessDefinedStep()->GetProcessName();
-  G4int copy_no = step->GetPostStepPoint()->GetTouchable()->GetReplicaNumber(1);
-  */
-
-  /*
-  // Retrieve the pointer to the optical boundary process.
-  // We do this only once per run defining our local pointer as static.
-  static G4OpBoundaryProcess* boundary = 0;
-
-  if (!boundary) { // the pointer is not defined yet
-    // Get the list of processes defined for the optical photon
-    // and loop through it to find the optical boundary process.
-    G4ProcessVector* pv = pdef->GetProcessManager()->GetProcessList();
-    for (G4int i=0; i<pv->size(); i++) {
-      if ((*pv)[i]->GetProcessName() == "OpBoundary") {
-        boundary = (G4OpBoundaryProcess*) (*pv)[i];
-        break;
-      }
+    // Photons absorbed by the escape surface of the envelope
+    if (envelope_logic_vol_ && track->GetTrackStatus() == fStopAndKill &&
+        post->GetStepStatus() == fGeomBoundary &&
+        pre_volume == envelope_logic_vol_ && post_volume == world_logic_vol_) {
+      kill_counters_->escaped += 1;
+      if (photon_fate_) photon_fate_->AddFate(pre_volume, PhotonFate::kEscaped);
+      return;
     }
   }
 
-  if (step->GetPostStepPoint()->GetStepStatus() == fGeomBoundary) {
-    if (boundary->GetStatus() == Detection ){
-      G4String detector_name = step->GetPostStepPoint()->GetTouchableHandle()->GetVolume()->GetName();
-      G4cout << "##### Sensitive Volume: " << detector_name << G4endl;
+  // Photons leaving the region around the plate cannot come back
+  // to the sensors (unless scattered back, which is neglected)
+  if (kill_radius2_ > 0. && post->GetPosition().mag2() > kill_radius2_) {
+    track->SetTrackStatus(fStopAndKill);
+    kill_counters_->escaped += 1;
+    if (photon_fate_) photon_fate_->AddFate(pre_volume, PhotonFate::kEscaped);
+    return;
+  }
+
+  if (photon_fate_ && track->GetTrackStatus() == fStopAndKill)
+    RecordFate(step, pre_volume, post_volume);
+
+  if (track->GetParentID() == 0) return;
+
+  if (trace_period_ > 0 && --trace_countdown_ <= 0) {
+    trace_countdown_ = trace_period_;
+    Trace(step);
+  }
+}
+
+
+void SteppingAction::RecordFate(const G4Step* step,
+                                const G4LogicalVolume* pre_volume,
+                                const G4LogicalVolume* post_volume)
+{
+  const G4StepPoint* post = step->GetPostStepPoint();
+
+  if (post->GetStepStatus() == fWorldBoundary) {
+    photon_fate_->AddFate(pre_volume, PhotonFate::kEscaped);
+    return;
+  }
+
+  const G4VProcess* process = post->GetProcessDefinedStep();
+  const G4int subtype = process ? process->GetProcessSubType() : -1;
+
+  if (subtype == fOpAbsorption) {
+    photon_fate_->AddFate(pre_volume, PhotonFate::kBulkAbsorbed);
+  }
+  else if (subtype == fOpWLS) {
+    photon_fate_->AddFate(pre_volume, PhotonFate::kWLSAbsorbed);
+  }
+  else if (subtype == fOpBoundary && boundary_ && post_volume) {
+    const G4OpBoundaryProcessStatus status = boundary_->GetStatus();
+    if (status == Detection)
+      photon_fate_->AddFate(post_volume, PhotonFate::kDetected);
+    else if (status == Absorption)
+      photon_fate_->AddFate(post_volume, PhotonFate::kSurfaceAbsorbed);
+    else
+      photon_fate_->AddFate(post_volume, PhotonFate::kOther);
+  }
+  else {
+    photon_fate_->AddFate(pre_volume, PhotonFate::kOther);
+  }
+}
+
+
+void SteppingAction::RecordPath(const G4Step* step,
+                                const G4LogicalVolume* post_volume)
+{
+  G4Track* track = step->GetTrack();
+
+  // Attached by the stacking action when the photon was created
+  PhotonPath* path = static_cast<PhotonPath*>(track->GetUserInformation());
+  if (!path) return;
+
+  const G4StepPoint* post = step->GetPostStepPoint();
+
+  if (boundary_ && post_volume && post->GetStepStatus() == fGeomBoundary) {
+    const G4OpBoundaryProcessStatus status = boundary_->GetStatus();
+    if (status == SpikeReflection || status == LobeReflection ||
+        status == LambertianReflection || status == BackScattering) {
+      for (G4int s=0; s<PathRecordFormat::kNumSurfaces; ++s)
+        if (post_volume == foil_logic_vol_[s])
+          path->AddReflection(PathRecordFormat::Surface(s));
+    }
+  }
 
-      // detectorCounts::iterator it = my_counts_.find(detector_name);
-      // if (it != my_counts_.end()) my_counts_[it->first] += 1;
-      // else my_counts_[detector_name] = 1;
+  // Photons re-emitted by WLS continue the path of the absorbed one
+  const G4VProcess* process = post->GetProcessDefinedStep();
+  if (process && process->GetProcessSubType() == fOpWLS) {
+    for (const G4Track* secondary: *step->GetSecondaryInCurrentStep()) {
+      PhotonPath* secondary_path = new PhotonPath(*path);
+      secondary_path->AddWLS();
+      const_cast<G4Track*>(secondary)->SetUserInformation(secondary_path);
     }
   }
-  */
-  return;
+}
+
+
+void SteppingAction::Trace(const G4Step* step)
+{
+  const G4Track* track = step->GetTrack();
+
+  TraceEntry entry = {track->GetTrackID(),
+                      track->GetCurrentStepNumber(),
+                      track->GetVolume()};
 
+  if (trace_.size() < static_cast<size_t>(trace_size_))
+    trace_.push_back(entry);
+  else
+    trace_[trace_count_ % trace_size_] = entry;
+
+  ++trace_count_;
+}
+
+
+void SteppingAction::EndOfRun() const
+{
+  if (trace_.empty()) return;
+
+  // Print the trace buffer from the oldest to the newest entry
+  const size_t size  = trace_.size();
+  const size_t first = (trace_count_ > static_cast<G4long>(size)) ?
+                       trace_count_ % size : 0;
+
+  G4cout << "Step trace (1 in " << trace_period_ << " steps, last "
+         << size << " of " << trace_count_ << " samples):" << G4endl;
+
+  for (size_t i=0; i<size; ++i) {
+    const TraceEntry& entry = trace_[(first + i) % size];
+    G4cout << "  track_id: " << entry.track_id
+           << ", step_number: " << entry.step_number
+           << ", volume_name: " << entry.volume->GetName() << '\n';
+  }
+  G4cout << G4endl;
 }
@@ -7,19 +7,87 @@
 #ifndef STEPPING_ACTION_H
 #define STEPPING_ACTION_H
 
+#include "PathRecordFormat.h"
+
 #include <G4UserSteppingAction.hh>
+#include <globals.hh>
+
+#include <vector>
 
 class G4Step;
+class G4LogicalVolume;
+class G4VPhysicalVolume;
+class G4ParticleDefinition;
+class G4GenericMessenger;
+class StackingAction;
+class KillCounters;
+class PhotonFate;
+class StepProfiler;
+class G4OpBoundaryProcess;
 
 
 class SteppingAction: public G4UserSteppingAction
 {
 public:
-  SteppingAction();
+  // Optical photons leaving the kill region defined in the stacking
+  // action are killed and counted (if both pointers are given). Photons
+  // terminated at the envelope walls and optical-photon steps are also
+  // counted. Steps, boundary interactions and fates of the optical photons
+  // are recorded per volume if a PhotonFate accumulable is given, and
+  // steps of all particles are handed to the step profiler (if enabled).
+  // If a photon path file is being written, the reflections on the foils
+  // and the WLS conversions of every optical photon are tracked too.
+  SteppingAction(const StackingAction* stacking_action=nullptr,
+                 KillCounters* counters=nullptr,
+                 PhotonFate* photon_fate=nullptr,
+                 StepProfiler* step_profiler=nullptr);
   virtual ~SteppingAction();
   virtual void UserSteppingAction(const G4Step*);
+
+  // Resolve the volumes and processes of interest and reset the trace buffer.
+  // Invoked by the run action at the beginning of every run, once the
+  // geometry has been closed.
+  void BeginOfRun();
+  // Flush the trace buffer (if enabled).
+  void EndOfRun() const;
+
+private:
+  struct TraceEntry {
+    G4int track_id;
+    G4int step_number;
+    const G4VPhysicalVolume* volume;
+  };
+
+  void Trace(const G4Step*);
+  void RecordFate(const G4Step*, const G4LogicalVolume* pre_volume,
+                  const G4LogicalVolume* post_volume);
+  void RecordPath(const G4Step*, const G4LogicalVolume* post_volume);
+
 private:
-  int counter;
+  const G4ParticleDefinition* opticalphoton_;
+  const G4LogicalVolume* world_logic_vol_;
+  const G4LogicalVolume* envelope_logic_vol_;
+  G4OpBoundaryProcess* boundary_;
+
+  G4bool record_paths_;
+  const G4LogicalVolume* foil_logic_vol_[PathRecordFormat::kNumSurfaces];
+
+  const StackingAction* stacking_action_;
+  KillCounters* kill_counters_;
+  G4double kill_radius2_; // squared radius of the kill region (0: none)
+
+  PhotonFate* photon_fate_;
+  StepProfiler* step_profiler_;
+
+  // Sampled trace of steps: one in every trace_period_ photon steps is
+  // stored in a fixed-size ring buffer that is only printed at the end of
+  // the run. A period of 0 disables the trace.
+  G4int trace_period_, trace_size_;
+  G4int trace_countdown_;
+  G4long trace_count_;
+  std::vector<TraceEntry> trace_;
+
+  G4GenericMessenger* msg_;
 };
 
 #endif
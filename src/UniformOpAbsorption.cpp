@@ -0,0 +1,36 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | UniformOpAbsorption.cpp
+//
+//  Bulk absorption of optical photons with uniform-grid lookups.
+// -----------------------------------------------------------------------------
+
+#include "UniformOpAbsorption.h"
+
+#include <G4Track.hh>
+
+
+UniformOpAbsorption::UniformOpAbsorption(G4double tolerance):
+  G4OpAbsorption(), tolerance_(tolerance)
+{
+}
+
+
+UniformOpAbsorption::~UniformOpAbsorption()
+{
+}
+
+
+void UniformOpAbsorption::BuildPhysicsTable(const G4ParticleDefinition& particle)
+{
+  G4OpAbsorption::BuildPhysicsTable(particle);
+  abslength_.Build("ABSLENGTH", tolerance_);
+}
+
+
+G4double UniformOpAbsorption::GetMeanFreePath(const G4Track& track, G4double,
+                                              G4ForceCondition*)
+{
+  const UniformPropertyVector* abslength = abslength_.Get(track.GetMaterial());
+  if (!abslength) return DBL_MAX;
+  return abslength->Value(track.GetDynamicParticle()->GetTotalMomentum());
+}
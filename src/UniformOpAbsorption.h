@@ -0,0 +1,31 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | UniformOpAbsorption.h
+//
+//  Bulk absorption of optical photons (G4OpAbsorption) with the ABSLENGTH
+//  of the materials looked up on uniform energy grids.
+// -----------------------------------------------------------------------------
+
+#ifndef UNIFORM_OP_ABSORPTION_H
+#define UNIFORM_OP_ABSORPTION_H
+
+#include "UniformPropertyVector.h"
+
+#include <G4OpAbsorption.hh>
+
+
+class UniformOpAbsorption: public G4OpAbsorption
+{
+public:
+  UniformOpAbsorption(G4double tolerance);
+  virtual ~UniformOpAbsorption();
+
+  virtual void BuildPhysicsTable(const G4ParticleDefinition&);
+
+  virtual G4double GetMeanFreePath(const G4Track&, G4double, G4ForceCondition*);
+
+private:
+  G4double tolerance_;
+  UniformPropertyTable abslength_;
+};
+
+#endif
@@ -0,0 +1,36 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | UniformOpWLS.cpp
+//
+//  Wavelength shifting of optical photons with uniform-grid lookups.
+// -----------------------------------------------------------------------------
+
+#include "UniformOpWLS.h"
+
+#include <G4Track.hh>
+
+
+UniformOpWLS::UniformOpWLS(G4double tolerance):
+  G4OpWLS(), tolerance_(tolerance)
+{
+}
+
+
+UniformOpWLS::~UniformOpWLS()
+{
+}
+
+
+void UniformOpWLS::BuildPhysicsTable(const G4ParticleDefinition& particle)
+{
+  G4OpWLS::BuildPhysicsTable(particle);
+  wls_abslength_.Build("WLSABSLENGTH", tolerance_);
+}
+
+
+G4double UniformOpWLS::GetMeanFreePath(const G4Track& track, G4double,
+                                              G4ForceCondition*)
+{
+  const UniformPropertyVector* abslength = wls_abslength_.Get(track.GetMaterial());
+  if (!abslength) return DBL_MAX;
+  return abslength->Value(track.GetDynamicParticle()->GetTotalMomentum());
+}
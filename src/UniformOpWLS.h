@@ -0,0 +1,31 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | UniformOpWLS.h
+//
+//  Wavelength shifting of optical photons (G4OpWLS) with the WLSABSLENGTH
+//  of the materials looked up on uniform energy grids.
+// -----------------------------------------------------------------------------
+
+#ifndef UNIFORM_OP_WLS_H
+#define UNIFORM_OP_WLS_H
+
+#include "UniformPropertyVector.h"
+
+#include <G4OpWLS.hh>
+
+
+class UniformOpWLS: public G4OpWLS
+{
+public:
+  UniformOpWLS(G4double tolerance);
+  virtual ~UniformOpWLS();
+
+  virtual void BuildPhysicsTable(const G4ParticleDefinition&);
+
+  virtual G4double GetMeanFreePath(const G4Track&, G4double, G4ForceCondition*);
+
+private:
+  G4double tolerance_;
+  UniformPropertyTable wls_abslength_;
+};
+
+#endif
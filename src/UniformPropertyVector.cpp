@@ -0,0 +1,150 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | UniformPropertyVector.cpp
+//
+//  Material property resampled onto a uniform energy grid.
+// -----------------------------------------------------------------------------
+
+#include "UniformPropertyVector.h"
+
+#include <G4Material.hh>
+#include <G4MaterialPropertiesTable.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <cmath>
+#include <algorithm>
+
+
+UniformPropertyVector::UniformPropertyVector(const G4MaterialPropertyVector& vec,
+                                             G4double tolerance, G4int max_bins):
+  emin_(0.), emax_(0.), inv_step_(0.), num_bins_(1), exact_(false), max_error_(0.)
+{
+  const std::size_t n = vec.GetVectorLength();
+
+  if (n < 2 || vec.Energy(n-1) <= vec.Energy(0)) {
+    // Constant property
+    values_.assign(2, n > 0 ? vec[0] : 0.);
+    return;
+  }
+
+  emin_ = vec.Energy(0);
+  emax_ = vec.Energy(n-1);
+
+  // Start with a grid as fine as the average spacing of the table
+  // and halve the step until the tolerance is met.
+  for (G4int num_bins = n - 1; num_bins <= max_bins; num_bins *= 2) {
+    Resample(vec, num_bins);
+    max_error_ = MaxError(vec);
+    if (max_error_ <= tolerance) return;
+  }
+
+  // Resampling is not accurate enough: index the original nodes
+  G4double min_spacing = emax_ - emin_;
+  for (std::size_t i=1; i<n; ++i)
+    if (vec.Energy(i) > vec.Energy(i-1))
+      min_spacing = std::min(min_spacing, vec.Energy(i) - vec.Energy(i-1));
+
+  const G4double cells = std::ceil((emax_ - emin_) / min_spacing);
+  BuildIndex(vec, G4int(std::min(cells, G4double(max_bins))));
+}
+
+
+UniformPropertyVector::~UniformPropertyVector()
+{
+}
+
+
+void UniformPropertyVector::Resample(const G4MaterialPropertyVector& vec,
+                                     G4int num_bins)
+{
+  num_bins_ = num_bins;
+  inv_step_ = num_bins / (emax_ - emin_);
+
+  values_.resize(num_bins + 1);
+  for (G4int i=0; i<=num_bins; ++i)
+    values_[i] = vec.Value(std::min(emin_ + i / inv_step_, emax_));
+}
+
+
+void UniformPropertyVector::BuildIndex(const G4MaterialPropertyVector& vec,
+                                       G4int num_bins)
+{
+  exact_ = true;
+  max_error_ = 0.;
+  num_bins_ = num_bins;
+  inv_step_ = num_bins / (emax_ - emin_);
+
+  const std::size_t n = vec.GetVectorLength();
+  energies_.resize(n);
+  values_.resize(n);
+  for (std::size_t i=0; i<n; ++i) {
+    energies_[i] = vec.Energy(i);
+    values_[i] = vec[i];
+  }
+
+  index_.resize(num_bins);
+  G4int segment = 0;
+  for (G4int i=0; i<num_bins; ++i) {
+    const G4double low_edge = emin_ + i / inv_step_;
+    while (segment < G4int(n)-2 && energies_[segment+1] <= low_edge) ++segment;
+    index_[i] = segment;
+  }
+}
+
+
+G4double UniformPropertyVector::MaxError(const G4MaterialPropertyVector& vec) const
+{
+  // Both tables are piecewise linear and agree at the nodes of the uniform
+  // grid, so the largest difference is found at the nodes of the original.
+  G4double max_error = 0.;
+
+  for (std::size_t i=0; i<vec.GetVectorLength(); ++i) {
+    const G4double exact = vec[i];
+    const G4double approx = Value(vec.Energy(i));
+    const G4double scale = std::max(std::abs(exact), DBL_MIN);
+    max_error = std::max(max_error, std::abs(approx - exact) / scale);
+  }
+
+  return max_error;
+}
+
+
+UniformPropertyTable::UniformPropertyTable()
+{
+}
+
+
+UniformPropertyTable::~UniformPropertyTable()
+{
+  Clear();
+}
+
+
+void UniformPropertyTable::Clear()
+{
+  for (UniformPropertyVector* vec: vectors_) delete vec;
+  vectors_.clear();
+}
+
+
+void UniformPropertyTable::Build(const G4String& key, G4double tolerance)
+{
+  Clear();
+
+  const G4MaterialTable* materials = G4Material::GetMaterialTable();
+  vectors_.resize(materials->size(), nullptr);
+
+  for (const G4Material* material: *materials) {
+    G4MaterialPropertiesTable* mpt = material->GetMaterialPropertiesTable();
+    if (!mpt) continue;
+    G4MaterialPropertyVector* vec = mpt->GetProperty(key);
+    if (!vec) continue;
+    vectors_[material->GetIndex()] = new UniformPropertyVector(*vec, tolerance);
+  }
+}
+
+
+const UniformPropertyVector* UniformPropertyTable::Get(const G4Material* material) const
+{
+  const std::size_t index = material->GetIndex();
+  return (index < vectors_.size()) ? vectors_[index] : nullptr;
+}
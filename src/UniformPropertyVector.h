@@ -0,0 +1,105 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | UniformPropertyVector.h
+//
+//  Material property (e.g. ABSLENGTH) served in constant time through a
+//  uniform energy grid, without the binary search of G4PhysicsVector.
+//  The property is resampled onto the grid, which is refined until the
+//  linear interpolation of the resampled table agrees with the original
+//  within a relative tolerance. Tables that would need too fine a grid
+//  (e.g. with steep steps) keep their original nodes instead, and the grid
+//  only maps every cell to the first table segment it overlaps, so the
+//  interpolation is exact. Outside the tabulated range the edge values are
+//  returned, as G4PhysicsVector does.
+// -----------------------------------------------------------------------------
+
+#ifndef UNIFORM_PROPERTY_VECTOR_H
+#define UNIFORM_PROPERTY_VECTOR_H
+
+#include <G4MaterialPropertyVector.hh>
+#include <globals.hh>
+
+#include <vector>
+
+class G4Material;
+
+
+class UniformPropertyVector
+{
+public:
+  UniformPropertyVector(const G4MaterialPropertyVector&,
+                        G4double tolerance=1.e-3, G4int max_bins=4096);
+  ~UniformPropertyVector();
+
+  G4double Value(G4double energy) const;
+
+  G4int GetNumBins() const;
+  // Whether the original nodes are interpolated (no resampling)
+  G4bool IsExact() const;
+  // Maximum relative difference with the original table
+  G4double GetMaxError() const;
+
+private:
+  void Resample(const G4MaterialPropertyVector&, G4int num_bins);
+  void BuildIndex(const G4MaterialPropertyVector&, G4int num_bins);
+  G4double MaxError(const G4MaterialPropertyVector&) const;
+
+private:
+  G4double emin_, emax_;
+  G4double inv_step_;
+  G4int num_bins_;
+  G4bool exact_;
+  std::vector<G4double> values_;   // resampled: num_bins+1 nodes; exact: original
+  std::vector<G4double> energies_; // exact mode: original nodes
+  std::vector<G4int> index_;       // exact mode: first segment of every cell
+  G4double max_error_;
+};
+
+inline G4int UniformPropertyVector::GetNumBins() const { return num_bins_; }
+inline G4bool UniformPropertyVector::IsExact() const { return exact_; }
+inline G4double UniformPropertyVector::GetMaxError() const { return max_error_; }
+
+inline G4double UniformPropertyVector::Value(G4double energy) const
+{
+  if (energy <= emin_) return values_.front();
+  if (energy >= emax_) return values_.back();
+
+  const G4double x = (energy - emin_) * inv_step_;
+  G4int i = static_cast<G4int>(x);
+  if (i >= num_bins_) i = num_bins_ - 1; // rounding at the upper edge
+
+  if (!exact_) {
+    const G4double f = x - i;
+    return values_[i] + f * (values_[i+1] - values_[i]);
+  }
+
+  // Cells are at most as wide as the narrowest segment (up to the
+  // maximum number of bins), so this loop takes very few iterations.
+  i = index_[i];
+  while (energies_[i+1] < energy) ++i;
+  const G4double f = (energy - energies_[i]) / (energies_[i+1] - energies_[i]);
+  return values_[i] + f * (values_[i+1] - values_[i]);
+}
+
+
+// Uniform vectors of a given property for all the materials that define
+// it, indexed by material.
+class UniformPropertyTable
+{
+public:
+  UniformPropertyTable();
+  ~UniformPropertyTable();
+
+  // (Re)build the vectors from the current material table
+  void Build(const G4String& key, G4double tolerance=1.e-3);
+
+  // Null if the material does not define the property
+  const UniformPropertyVector* Get(const G4Material*) const;
+
+private:
+  void Clear();
+
+private:
+  std::vector<UniformPropertyVector*> vectors_; // by material index
+};
+
+#endif
@@ -0,0 +1,227 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | VisibilityBuilder.cpp
+//
+//  Accumulation and writing of the photon visibility library.
+// -----------------------------------------------------------------------------
+
+#include "VisibilityBuilder.h"
+#include "VisibilityFormat.h"
+
+#include <G4GenericMessenger.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+
+
+static_assert(VisibilityFormat::kHostIsLittleEndian,
+              "Visibility libraries are little-endian; big-endian hosts are not supported.");
+
+
+VisibilityBuilder& VisibilityBuilder::Instance()
+{
+  static VisibilityBuilder instance;
+  return instance;
+}
+
+
+VisibilityBuilder::VisibilityBuilder():
+  filename_(""),
+  grid_min_(-10.*cm,  1.*cm, -30.*cm),
+  grid_max_( 10.*cm, 21.*cm,  30.*cm),
+  num_voxels_{10, 10, 20},
+  time_bin_width_(2.*ns), num_time_bins_(100),
+  num_sensors_(0),
+  msg_(nullptr)
+{
+  // The library is written by the master thread, while the workers only
+  // read the grid definition: commands do not need to be broadcast.
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/visibility/",
+                                "Control of the photon visibility library.");
+
+  msg_->DeclareProperty("output", filename_,
+                        "Library file written in voxel-scan mode (empty: none).")
+    .SetParameterName("filename", true)
+    .SetDefaultValue("")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclarePropertyWithUnit("gridMin", "cm", grid_min_,
+                                "Lower corner of the voxel grid.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclarePropertyWithUnit("gridMax", "cm", grid_max_,
+                                "Upper corner of the voxel grid.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareMethod("numVoxels", &VisibilityBuilder::SetNumVoxels,
+                      "Number of voxels along x, y and z.")
+    .SetParameterName("n", false)
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclarePropertyWithUnit("timeBinWidth", "ns", time_bin_width_,
+                                "Width of the arrival-time bins.")
+    .SetParameterName("width", false)
+    .SetRange("width>0.")
+    .SetToBeBroadcasted(false);
+
+  msg_->DeclareProperty("numTimeBins", num_time_bins_,
+                        "Number of arrival-time bins (later arrivals "
+                        "are added to the last bin).")
+    .SetParameterName("n", false)
+    .SetRange("n>0")
+    .SetToBeBroadcasted(false);
+}
+
+
+VisibilityBuilder::~VisibilityBuilder()
+{
+  delete msg_;
+}
+
+
+void VisibilityBuilder::SetNumVoxels(const G4String& value)
+{
+  std::istringstream iss(value);
+  G4int n[3];
+  if (!(iss >> n[0] >> n[1] >> n[2]) || n[0] < 1 || n[1] < 1 || n[2] < 1) {
+    G4ExceptionDescription ed;
+    ed << "Invalid number of voxels '" << value << "' (expected nx ny nz > 0).";
+    G4Exception("VisibilityBuilder::SetNumVoxels()", "VisibilityBuilder",
+                JustWarning, ed);
+    return;
+  }
+  std::copy(n, n+3, num_voxels_);
+}
+
+
+void VisibilityBuilder::GetVoxelBounds(G4int voxel,
+                                       G4ThreeVector& min, G4ThreeVector& max) const
+{
+  const G4int index[3] = {voxel % num_voxels_[0],
+                          voxel / num_voxels_[0] % num_voxels_[1],
+                          voxel / (num_voxels_[0] * num_voxels_[1])};
+
+  for (G4int i=0; i<3; ++i) {
+    const G4double size = (grid_max_[i] - grid_min_[i]) / num_voxels_[i];
+    min[i] = grid_min_[i] + index[i] * size;
+    max[i] = min[i] + size;
+  }
+}
+
+
+void VisibilityBuilder::Begin()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  num_sensors_ = 0;
+  emitted_.assign(GetNumVoxels(), 0);
+  detected_.clear();
+  times_.clear();
+}
+
+
+void VisibilityBuilder::Add(G4int voxel, G4int num_photons,
+                            const OpticalHitCollection& hc)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (num_sensors_ == 0) {
+    num_sensors_ = hc.entries();
+    detected_.assign(std::size_t(GetNumVoxels()) * num_sensors_, 0);
+    times_.assign(detected_.size() * num_time_bins_, 0);
+  }
+
+  emitted_[voxel] += num_photons;
+
+  for (size_t i=0; i<hc.entries(); ++i) {
+    const OpticalHit* hit = hc[i];
+    if (hit->GetWaveform().empty()) continue;
+
+    const std::size_t k = std::size_t(voxel) * num_sensors_ + hit->GetSensorID();
+    std::uint32_t* times = &times_[k * num_time_bins_];
+    const G4double half_bin = hit->GetTimeBinWidth() / 2.;
+
+    for (const auto& bin: hit->GetWaveform()) {
+      // Centre of the waveform bin (emission is at t=0 in scan mode)
+      G4int t = G4int((bin.first + half_bin) / time_bin_width_);
+      times[std::min(std::max(t, 0), num_time_bins_-1)] += bin.second;
+      detected_[k] += bin.second;
+    }
+  }
+}
+
+
+void VisibilityBuilder::End()
+{
+  if (filename_.empty() || num_sensors_ == 0) return;
+  Write();
+}
+
+
+void VisibilityBuilder::Write()
+{
+  const std::size_t voxels = GetNumVoxels();
+  const std::size_t sensors = num_sensors_;
+  const std::size_t nt = num_time_bins_;
+
+  VisibilityFormat::Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, VisibilityFormat::kMagic, sizeof(header.magic));
+  header.version = VisibilityFormat::kVersion;
+  header.num_sensors = sensors;
+  header.num_time_bins = nt;
+  for (G4int i=0; i<3; ++i) {
+    header.num_voxels[i] = num_voxels_[i];
+    header.grid_min[i] = grid_min_[i] / mm;
+    header.grid_max[i] = grid_max_[i] / mm;
+  }
+  header.time_bin_width = time_bin_width_ / ns;
+  header.probability_offset = VisibilityFormat::ProbabilityOffset();
+  header.time_cdf_offset = VisibilityFormat::TimeCDFOffset(voxels, sensors);
+
+  std::vector<char> buffer(VisibilityFormat::FileSize(voxels, sensors, nt), 0);
+  std::memcpy(buffer.data(), &header, sizeof(header));
+
+  float* probability =
+    reinterpret_cast<float*>(&buffer[header.probability_offset]);
+  std::uint16_t* time_cdf =
+    reinterpret_cast<std::uint16_t*>(&buffer[header.time_cdf_offset]);
+
+  G4int empty_voxels = 0;
+
+  for (std::size_t v=0; v<voxels; ++v) {
+    if (emitted_[v] == 0) { ++empty_voxels; continue; }
+    for (std::size_t s=0; s<sensors; ++s) {
+      const std::size_t k = v * sensors + s;
+      if (detected_[k] == 0) continue;
+      probability[k] = G4double(detected_[k]) / emitted_[v];
+      std::uint64_t sum = 0;
+      for (std::size_t t=0; t<nt; ++t) {
+        sum += times_[k*nt + t];
+        time_cdf[k*nt + t] = std::uint16_t(G4double(sum) / detected_[k] *
+                                           VisibilityFormat::kCDFMax + 0.5);
+      }
+    }
+  }
+
+  std::FILE* file = std::fopen(filename_.c_str(), "wb");
+  if (!file || std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+    G4ExceptionDescription ed;
+    ed << "Error writing visibility library " << filename_ << ".";
+    G4Exception("VisibilityBuilder::Write()", "VisibilityBuilder",
+                JustWarning, ed);
+  }
+  if (file) std::fclose(file);
+
+  G4cout << "[VisibilityBuilder] Library with " << voxels << " voxels and "
+         << sensors << " sensors written to " << filename_ << G4endl;
+
+  if (empty_voxels > 0) {
+    G4ExceptionDescription ed;
+    ed << empty_voxels << " voxels were not scanned (run at least "
+       << voxels << " events).";
+    G4Exception("VisibilityBuilder::Write()", "VisibilityBuilder",
+                JustWarning, ed);
+  }
+}
@@ -0,0 +1,80 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | VisibilityBuilder.h
+//
+//  Accumulates the photon visibility library (see VisibilityFormat.h) in
+//  the voxel-scan mode of the primary generator: every event emits photons
+//  from a single voxel of the grid, and its hits are added here by the
+//  event action. There is a single instance shared by all threads (updates
+//  are serialized with a lock); the master run action writes the library
+//  at the end of the run.
+// -----------------------------------------------------------------------------
+
+#ifndef VISIBILITY_BUILDER_H
+#define VISIBILITY_BUILDER_H
+
+#include "OpticalHit.h"
+
+#include <G4ThreeVector.hh>
+#include <globals.hh>
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+class G4GenericMessenger;
+
+
+class VisibilityBuilder
+{
+public:
+  static VisibilityBuilder& Instance();
+
+  // Reset the accumulated data (beginning of run)
+  void Begin();
+  // Write the library if an output file has been configured (end of run)
+  void End();
+
+  G4int GetNumVoxels() const;
+
+  // Voxel scanned by a given event
+  G4int GetVoxelForEvent(G4int event_id) const;
+  // Corners of a voxel
+  void GetVoxelBounds(G4int voxel, G4ThreeVector& min, G4ThreeVector& max) const;
+
+  // Add the hits of an event that emitted num_photons in a voxel (thread-safe)
+  void Add(G4int voxel, G4int num_photons, const OpticalHitCollection&);
+
+private:
+  VisibilityBuilder();
+  ~VisibilityBuilder();
+  VisibilityBuilder(const VisibilityBuilder&) = delete;
+  VisibilityBuilder& operator=(const VisibilityBuilder&) = delete;
+
+  void SetNumVoxels(const G4String&);
+  void Write();
+
+private:
+  G4String filename_;
+
+  G4ThreeVector grid_min_, grid_max_;
+  G4int num_voxels_[3];
+  G4double time_bin_width_;
+  G4int num_time_bins_;
+
+  G4int num_sensors_; // set with the first event added
+  std::vector<std::uint64_t> emitted_;  // [voxel]
+  std::vector<std::uint64_t> detected_; // [voxel][sensor]
+  std::vector<std::uint32_t> times_;    // [voxel][sensor][time bin]
+
+  std::mutex mutex_;
+
+  G4GenericMessenger* msg_;
+};
+
+inline G4int VisibilityBuilder::GetNumVoxels() const
+{ return num_voxels_[0] * num_voxels_[1] * num_voxels_[2]; }
+
+inline G4int VisibilityBuilder::GetVoxelForEvent(G4int event_id) const
+{ return event_id % GetNumVoxels(); }
+
+#endif
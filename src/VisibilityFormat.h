@@ -0,0 +1,72 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | VisibilityFormat.h
+//
+//  Layout of the photon visibility library files: for every voxel of a
+//  regular grid and every sensor, the probability that a photon emitted
+//  isotropically in the voxel is detected by the sensor, and the
+//  cumulative distribution of its arrival time. All values little-endian.
+//
+//    header       Header
+//    probability  float32[num_voxels][num_sensors]
+//    time_cdf     uint16[num_voxels][num_sensors][num_time_bins]
+//
+//  The time CDFs are quantized to kCDFMax (i.e. the last bin of a sensor
+//  with detections holds kCDFMax). Both arrays start at offsets aligned to
+//  kAlignment bytes, so that a memory-mapped file can be accessed through
+//  plain typed pointers. This header does not depend on Geant4.
+// -----------------------------------------------------------------------------
+
+#ifndef VISIBILITY_FORMAT_H
+#define VISIBILITY_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+
+
+namespace VisibilityFormat {
+
+  const char kMagic[8] = {'G','4','O','S','V','I','S','L'};
+
+  const std::uint32_t kVersion = 1;
+
+  // The library is dumped from memory by the builder and mapped as is by
+  // the reader: both require a little-endian host.
+  const bool kHostIsLittleEndian = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+  const std::size_t kAlignment = 64;
+
+  const std::uint16_t kCDFMax = 65535;
+
+  struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_sensors;
+    std::uint32_t num_voxels[3];   // along x, y, z
+    std::uint32_t num_time_bins;
+    float grid_min[3];             // mm
+    float grid_max[3];             // mm
+    float time_bin_width;          // ns
+    std::uint32_t reserved;
+    std::uint64_t probability_offset;
+    std::uint64_t time_cdf_offset;
+  };
+
+  inline std::size_t Align(std::size_t n)
+  { return (n + kAlignment - 1) / kAlignment * kAlignment; }
+
+  inline std::size_t ProbabilityOffset()
+  { return Align(sizeof(Header)); }
+
+  inline std::size_t TimeCDFOffset(std::size_t voxels, std::size_t sensors)
+  { return ProbabilityOffset() + Align(voxels * sensors * sizeof(float)); }
+
+  inline std::size_t FileSize(std::size_t voxels, std::size_t sensors,
+                              std::size_t time_bins)
+  {
+    return TimeCDFOffset(voxels, sensors) +
+           Align(voxels * sensors * time_bins * sizeof(std::uint16_t));
+  }
+
+} // end namespace VisibilityFormat
+
+#endif
@@ -0,0 +1,172 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | VisibilityLibrary.cpp
+//
+//  Read-only access to a photon visibility library.
+// -----------------------------------------------------------------------------
+
+#include "VisibilityLibrary.h"
+
+#include <G4GenericMessenger.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+static_assert(VisibilityFormat::kHostIsLittleEndian,
+              "Visibility libraries are little-endian; big-endian hosts are not supported.");
+
+
+VisibilityLibrary& VisibilityLibrary::Instance()
+{
+  static VisibilityLibrary instance;
+  return instance;
+}
+
+
+VisibilityLibrary::VisibilityLibrary():
+  filename_(""), data_(nullptr), size_(0),
+  header_(nullptr), probability_(nullptr), time_cdf_(nullptr),
+  num_voxels_(0), voxel_size_{0., 0., 0.},
+  msg_(nullptr)
+{
+  // The library is loaded by the master thread and shared with the
+  // workers: commands do not need to be broadcast.
+  msg_ = new G4GenericMessenger(this, "/G4OpSim/visibility/",
+                                "Control of the photon visibility library.");
+
+  msg_->DeclareMethod("library", &VisibilityLibrary::Load,
+                      "Load a photon visibility library for the fast mode.")
+    .SetParameterName("filename", false)
+    .SetToBeBroadcasted(false);
+}
+
+
+VisibilityLibrary::~VisibilityLibrary()
+{
+  Unload();
+  delete msg_;
+}
+
+
+void VisibilityLibrary::Load(const G4String& filename)
+{
+  Unload();
+
+  G4int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    G4ExceptionDescription ed;
+    ed << "Cannot open visibility library " << filename << ".";
+    G4Exception("VisibilityLibrary::Load()", "VisibilityLibrary",
+                FatalErrorInArgument, ed);
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    G4ExceptionDescription ed;
+    ed << "Cannot stat visibility library " << filename << ".";
+    G4Exception("VisibilityLibrary::Load()", "VisibilityLibrary",
+                FatalErrorInArgument, ed);
+    return;
+  }
+  size_ = st.st_size;
+
+  if (size_ >= sizeof(VisibilityFormat::Header))
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (!data_ || data_ == MAP_FAILED) {
+    data_ = nullptr;
+    G4ExceptionDescription ed;
+    ed << "Cannot map visibility library " << filename << ".";
+    G4Exception("VisibilityLibrary::Load()", "VisibilityLibrary",
+                FatalErrorInArgument, ed);
+    return;
+  }
+
+  const VisibilityFormat::Header* header =
+    static_cast<const VisibilityFormat::Header*>(data_);
+
+  const std::size_t voxels = std::size_t(header->num_voxels[0]) *
+    header->num_voxels[1] * header->num_voxels[2];
+
+  if (std::memcmp(header->magic, VisibilityFormat::kMagic, 8) != 0 ||
+      header->version != VisibilityFormat::kVersion ||
+      size_ < VisibilityFormat::FileSize(voxels, header->num_sensors,
+                                         header->num_time_bins)) {
+    Unload();
+    G4ExceptionDescription ed;
+    ed << filename << " is not a valid visibility library.";
+    G4Exception("VisibilityLibrary::Load()", "VisibilityLibrary",
+                FatalErrorInArgument, ed);
+    return;
+  }
+
+  filename_ = filename;
+  header_ = header;
+
+  const char* bytes = static_cast<const char*>(data_);
+  probability_ = reinterpret_cast<const float*>(bytes + header->probability_offset);
+  time_cdf_ = reinterpret_cast<const std::uint16_t*>(bytes + header->time_cdf_offset);
+
+  num_voxels_ = voxels;
+  for (G4int i=0; i<3; ++i)
+    voxel_size_[i] = (header->grid_max[i] - header->grid_min[i]) * mm /
+                     header->num_voxels[i];
+
+  G4cout << "[VisibilityLibrary] " << filename_ << ": "
+         << header->num_voxels[0] << " x " << header->num_voxels[1] << " x "
+         << header->num_voxels[2] << " voxels, "
+         << header->num_sensors << " sensors, "
+         << header->num_time_bins << " time bins." << G4endl;
+}
+
+
+void VisibilityLibrary::Unload()
+{
+  if (data_) munmap(data_, size_);
+  data_ = nullptr;
+  size_ = 0;
+  header_ = nullptr;
+  probability_ = nullptr;
+  time_cdf_ = nullptr;
+  num_voxels_ = 0;
+}
+
+
+G4int VisibilityLibrary::GetVoxel(const G4ThreeVector& point) const
+{
+  G4int index[3];
+
+  for (G4int i=0; i<3; ++i) {
+    G4double x = (point[i] - header_->grid_min[i]*mm) / voxel_size_[i];
+    if (x < 0. || x >= header_->num_voxels[i]) return -1;
+    index[i] = G4int(x);
+  }
+
+  return index[0] + header_->num_voxels[0] *
+    (index[1] + header_->num_voxels[1] * index[2]);
+}
+
+
+G4double VisibilityLibrary::SampleTime(G4int voxel, G4int sensor,
+                                       G4double u1, G4double u2) const
+{
+  const std::size_t nt = header_->num_time_bins;
+  const std::uint16_t* cdf = time_cdf_ +
+    (std::size_t(voxel) * header_->num_sensors + sensor) * nt;
+
+  const G4double target = u1 * VisibilityFormat::kCDFMax;
+  std::size_t bin = std::upper_bound(cdf, cdf+nt, target) - cdf;
+  if (bin >= nt) bin = nt - 1;
+
+  return (bin + u2) * header_->time_bin_width * ns;
+}
@@ -0,0 +1,78 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | VisibilityLibrary.h
+//
+//  Read-only access to a photon visibility library (see VisibilityFormat.h).
+//  The file is memory-mapped, so that its pages are shared by all the
+//  threads of the job and by any other process using the same library.
+//  There is a single instance, loaded from a macro command before the run;
+//  it is not modified afterwards and can be used concurrently.
+// -----------------------------------------------------------------------------
+
+#ifndef VISIBILITY_LIBRARY_H
+#define VISIBILITY_LIBRARY_H
+
+#include "VisibilityFormat.h"
+
+#include <G4ThreeVector.hh>
+#include <globals.hh>
+
+class G4GenericMessenger;
+
+
+class VisibilityLibrary
+{
+public:
+  static VisibilityLibrary& Instance();
+
+  // Map the given library file, replacing any previously loaded one
+  void Load(const G4String& filename);
+  void Unload();
+
+  G4bool IsLoaded() const;
+
+  G4int GetNumVoxels() const;
+  G4int GetNumSensors() const;
+
+  // Index of the voxel containing the point (-1 if outside the grid)
+  G4int GetVoxel(const G4ThreeVector&) const;
+
+  // Detection probabilities of all sensors for a voxel
+  const float* GetProbabilities(G4int voxel) const;
+
+  // Arrival time (relative to emission) of a photon detected by a
+  // sensor, from two uniform random numbers
+  G4double SampleTime(G4int voxel, G4int sensor, G4double u1, G4double u2) const;
+
+private:
+  VisibilityLibrary();
+  ~VisibilityLibrary();
+  VisibilityLibrary(const VisibilityLibrary&) = delete;
+  VisibilityLibrary& operator=(const VisibilityLibrary&) = delete;
+
+private:
+  G4String filename_;
+
+  void* data_;
+  std::size_t size_;
+
+  const VisibilityFormat::Header* header_;
+  const float* probability_;
+  const std::uint16_t* time_cdf_;
+
+  G4int num_voxels_;
+  G4double voxel_size_[3];
+
+  G4GenericMessenger* msg_;
+};
+
+inline G4bool VisibilityLibrary::IsLoaded() const { return data_ != nullptr; }
+
+inline G4int VisibilityLibrary::GetNumVoxels() const { return num_voxels_; }
+
+inline G4int VisibilityLibrary::GetNumSensors() const
+{ return header_ ? header_->num_sensors : 0; }
+
+inline const float* VisibilityLibrary::GetProbabilities(G4int voxel) const
+{ return probability_ + std::size_t(voxel) * header_->num_sensors; }
+
+#endif
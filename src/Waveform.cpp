@@ -0,0 +1,204 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | Waveform.cpp
+//
+//  Time histogram of photon detections with fixed-width bins.
+// -----------------------------------------------------------------------------
+
+#include "Waveform.h"
+
+#include <algorithm>
+#include <limits>
+
+
+namespace {
+
+  // Zeroed dense arrays of destroyed waveforms, per thread. The pool is
+  // bounded so that an event with an unusually large number of hit sensors
+  // does not keep its memory for the rest of the run.
+  const std::size_t kMaxPooledArrays = 1024;
+  G4ThreadLocal std::vector<std::vector<G4int>>* dense_pool = nullptr;
+
+  const std::size_t kNoBin = std::numeric_limits<std::size_t>::max();
+
+  // Room made for bins outside the window on the first of them
+  const std::size_t kSparseReserve = 64;
+
+} // namespace
+
+
+Waveform::Waveform():
+  bin_width_(1.), window_(0.), num_dense_bins_(0), entries_(0), total_(0),
+  lo_(kNoBin), hi_(0)
+{
+}
+
+
+Waveform::Waveform(G4double bin_width, G4double window):
+  Waveform()
+{
+  SetBinning(bin_width, window);
+}
+
+
+Waveform::~Waveform()
+{
+  ReleaseDense();
+}
+
+
+void Waveform::SetBinning(G4double bin_width, G4double window)
+{
+  if (!empty()) {
+    G4Exception("Waveform::SetBinning()", "Waveform", JustWarning,
+                "A Waveform cannot be rebinned once it has been filled.");
+    return;
+  }
+
+  if (!(bin_width > 0.)) {
+    G4Exception("Waveform::SetBinning()", "Waveform", FatalErrorInArgument,
+                "The bin width must be positive.");
+    return;
+  }
+
+  bin_width_ = bin_width;
+  window_    = std::max(window, 0.);
+  const std::size_t num_dense_bins =
+    static_cast<std::size_t>(std::ceil(window_/bin_width_));
+  if (num_dense_bins != num_dense_bins_) ReleaseDense();
+  num_dense_bins_ = num_dense_bins;
+}
+
+
+void Waveform::Clear()
+{
+  entries_ = 0;
+  total_ = 0;
+  ZeroDense();
+  sparse_.clear();
+}
+
+
+void Waveform::ZeroDense()
+{
+  if (lo_ <= hi_)
+    std::fill(dense_.begin() + lo_, dense_.begin() + hi_ + 1, 0);
+  lo_ = kNoBin;
+  hi_ = 0;
+}
+
+
+void Waveform::AcquireDense()
+{
+  if (dense_pool) {
+    // Arrays of a different binning are left for the waveforms using it
+    for (auto it = dense_pool->rbegin(); it != dense_pool->rend(); ++it) {
+      if (it->size() != num_dense_bins_) continue;
+      dense_.swap(*it);
+      dense_pool->erase(std::next(it).base());
+      return;
+    }
+  }
+  dense_.assign(num_dense_bins_, 0);
+}
+
+
+void Waveform::ReleaseDense()
+{
+  if (dense_.empty()) return;
+  ZeroDense();
+
+  if (!dense_pool) dense_pool = new std::vector<std::vector<G4int>>;
+  if (dense_pool->size() < kMaxPooledArrays) {
+    dense_pool->push_back(std::vector<G4int>());
+    dense_pool->back().swap(dense_);
+  }
+  else {
+    std::vector<G4int>().swap(dense_);
+  }
+}
+
+
+void Waveform::FillSparse(G4long bin, G4int counts)
+{
+  if (sparse_.empty()) sparse_.reserve(kSparseReserve);
+
+  // Late detections mostly come in increasing bin order
+  if (sparse_.empty() || sparse_.back().first < bin) {
+    sparse_.emplace_back(bin, counts);
+    return;
+  }
+
+  auto it = std::lower_bound(sparse_.begin(), sparse_.end(), bin,
+    [](const std::pair<G4long, G4int>& entry, G4long b)
+    { return entry.first < b; });
+
+  if (it != sparse_.end() && it->first == bin) it->second += counts;
+  else sparse_.insert(it, std::make_pair(bin, counts));
+}
+
+
+std::size_t Waveform::size() const
+{
+  std::size_t n = sparse_.size();
+  for (std::size_t b=lo_; b<=hi_ && b<dense_.size(); ++b)
+    if (dense_[b] != 0) ++n;
+  return n;
+}
+
+
+Waveform::const_iterator::const_iterator(const Waveform* wvf, G4bool at_end):
+  wvf_(wvf), stage_(at_end ? 3 : 0), index_(0), value_(0., 0)
+{
+  if (!at_end) Settle();
+}
+
+
+Waveform::const_iterator& Waveform::const_iterator::operator++()
+{
+  ++index_;
+  Settle();
+  return *this;
+}
+
+
+void Waveform::const_iterator::Settle()
+{
+  const auto& sparse = wvf_->sparse_;
+  const auto& dense  = wvf_->dense_;
+
+  // Sparse bins below the readout window (negative bin numbers)
+  if (stage_ == 0) {
+    if (index_ < sparse.size() && sparse[index_].first < 0) {
+      value_ = value_type(sparse[index_].first * wvf_->bin_width_,
+                          sparse[index_].second);
+      return;
+    }
+    stage_ = 1;
+    index_ = wvf_->lo_;
+  }
+
+  // Non-empty bins of the dense array, within the range filled
+  if (stage_ == 1) {
+    const std::size_t end = (wvf_->lo_ <= wvf_->hi_) ? wvf_->hi_ + 1 : 0;
+    while (index_ < end && dense[index_] == 0) ++index_;
+    if (index_ < end) {
+      value_ = value_type(index_ * wvf_->bin_width_, dense[index_]);
+      return;
+    }
+    stage_ = 2;
+    index_ = std::lower_bound(sparse.begin(), sparse.end(), 0L,
+      [](const std::pair<G4long, G4int>& entry, G4long b)
+      { return entry.first < b; }) - sparse.begin();
+  }
+
+  // Sparse bins beyond the readout window
+  if (stage_ == 2) {
+    if (index_ < sparse.size()) {
+      value_ = value_type(sparse[index_].first * wvf_->bin_width_,
+                          sparse[index_].second);
+      return;
+    }
+    stage_ = 3;
+    index_ = 0;
+  }
+}
@@ -0,0 +1,160 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | Waveform.h
+//
+//  Time histogram of photon detections with fixed-width bins. Bins inside
+//  the readout window [0, window) are stored in a dense array indexed by
+//  bin number; the (rare) bins outside the window go to a sorted vector.
+//  Iteration visits the non-empty bins in increasing time order, yielding
+//  (bin low edge, counts) pairs as the std::map<G4double, G4int> used
+//  formerly by OpticalHit did.
+//
+//  The dense arrays are recycled: a Waveform that is cleared or destroyed
+//  zeroes only the range of bins it filled, and a destroyed one returns
+//  its array to a per-thread pool from which the next Waveform with the
+//  same binning takes it. A sensor hit of every event therefore neither
+//  allocates nor zeroes the whole readout window.
+// -----------------------------------------------------------------------------
+
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <globals.hh>
+
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <cmath>
+#include <cstddef>
+
+
+class Waveform
+{
+public:
+  typedef std::pair<G4double, G4int> value_type;
+  class const_iterator;
+
+  Waveform();
+  Waveform(G4double bin_width, G4double window);
+  ~Waveform();
+
+  // Set the width of the bins and the length of the readout window.
+  // Only allowed while the waveform is empty.
+  void SetBinning(G4double bin_width, G4double window);
+
+  G4double GetBinWidth() const;
+  G4double GetWindow() const;
+
+  void Fill(G4double time, G4int counts=1);
+  void Clear();
+
+  // True if Fill() has not been called since construction (or Clear())
+  bool empty() const;
+  // Number of non-empty bins (linear in the range of bins filled)
+  std::size_t size() const;
+  // Sum of the counts of all bins (kept up to date by Fill())
+  G4long GetTotalCounts() const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+private:
+  void FillSparse(G4long bin, G4int counts);
+
+  // Take a zeroed dense array from the pool (or allocate one)
+  void AcquireDense();
+  // Zero the filled bins and hand the dense array back to the pool
+  void ReleaseDense();
+  // Zero the range of dense bins filled so far
+  void ZeroDense();
+
+private:
+  G4double bin_width_;
+  G4double window_;
+  std::size_t num_dense_bins_;
+  G4long entries_;
+  G4long total_; // sum of the counts
+
+  std::vector<G4int> dense_; // taken from the pool on first fill
+  std::size_t lo_, hi_;      // range of dense bins filled (empty if lo_ > hi_)
+  std::vector<std::pair<G4long, G4int>> sparse_; // sorted by bin number
+
+  friend class const_iterator;
+};
+
+
+class Waveform::const_iterator
+{
+public:
+  typedef std::forward_iterator_tag iterator_category;
+  typedef Waveform::value_type value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const value_type* pointer;
+  typedef const value_type& reference;
+
+  const_iterator(const Waveform*, G4bool at_end);
+
+  reference operator*() const { return value_; }
+  pointer operator->() const { return &value_; }
+
+  const_iterator& operator++();
+  const_iterator operator++(int);
+
+  bool operator==(const const_iterator&) const;
+  bool operator!=(const const_iterator&) const;
+
+private:
+  // Sparse bins below the window come first (stage 0), then the
+  // non-empty dense bins within the range filled (stage 1) and last
+  // the sparse bins above
+  // the window (stage 2). Stage 3 marks the end of the sequence.
+  void Settle();
+
+private:
+  const Waveform* wvf_;
+  G4int stage_;
+  std::size_t index_;
+  value_type value_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+inline G4double Waveform::GetBinWidth() const { return bin_width_; }
+inline G4double Waveform::GetWindow() const { return window_; }
+
+inline bool Waveform::empty() const { return entries_ == 0; }
+inline G4long Waveform::GetTotalCounts() const { return total_; }
+
+inline void Waveform::Fill(G4double time, G4int counts)
+{
+  const G4double bin = std::floor(time/bin_width_);
+  ++entries_;
+  total_ += counts;
+
+  if (bin >= 0. && bin < num_dense_bins_) {
+    const std::size_t b = static_cast<std::size_t>(bin);
+    if (dense_.empty()) AcquireDense();
+    dense_[b] += counts;
+    if (b < lo_) lo_ = b;
+    if (b > hi_) hi_ = b;
+  }
+  else {
+    FillSparse(static_cast<G4long>(bin), counts);
+  }
+}
+
+inline Waveform::const_iterator Waveform::begin() const
+{ return const_iterator(this, false); }
+
+inline Waveform::const_iterator Waveform::end() const
+{ return const_iterator(this, true); }
+
+inline Waveform::const_iterator Waveform::const_iterator::operator++(int)
+{ const_iterator tmp(*this); ++(*this); return tmp; }
+
+inline bool Waveform::const_iterator::operator==(const const_iterator& other) const
+{ return wvf_ == other.wvf_ && stage_ == other.stage_ && index_ == other.index_; }
+
+inline bool Waveform::const_iterator::operator!=(const const_iterator& other) const
+{ return !(*this == other); }
+
+#endif
@@ -0,0 +1,270 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | tests/CompareSummary.cpp
+//
+//  Compares the JSON run summary of a regression run (see RunSummary.h)
+//  with a golden one recorded on the reference machine:
+//
+//   * physics: the number of detected photons of every sensor must agree
+//     within N standard deviations, sqrt(observed + golden) (i.e. the
+//     difference of two independent Poisson counts);
+//   * performance: the events per second must not drop by more than the
+//     given fraction of the golden value.
+//
+//  Returns 0 on success and 1 on any deviation or if there is no golden
+//  summary, unless --allow-missing is given (then 77, a skipped test).
+//  With --update, the observed summary becomes the golden one.
+//
+//  With --check identical, the second summary is that of the same run with
+//  a different number of threads instead: the events, photons, steps per
+//  photon and detected photons per sensor must be exactly the same.
+// -----------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace {
+
+  const int kSkipped = 77;
+
+  bool ReadFile(const std::string& filename, std::string& contents)
+  {
+    std::ifstream in(filename);
+    if (!in) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    contents = ss.str();
+    return true;
+  }
+
+  // Position right after '"key":' in the summary, or npos
+  std::size_t FindKey(const std::string& json, const std::string& key)
+  {
+    const std::size_t pos = json.find("\"" + key + "\"");
+    if (pos == std::string::npos) return pos;
+    const std::size_t colon = json.find(':', pos);
+    return (colon == std::string::npos) ? colon : colon + 1;
+  }
+
+  bool GetNumber(const std::string& json, const std::string& key, double& value)
+  {
+    const std::size_t pos = FindKey(json, key);
+    if (pos == std::string::npos) return false;
+    std::istringstream in(json.substr(pos));
+    return static_cast<bool>(in >> value);
+  }
+
+  bool GetArray(const std::string& json, const std::string& key,
+                std::vector<double>& values)
+  {
+    std::size_t pos = FindKey(json, key);
+    if (pos == std::string::npos) return false;
+    pos = json.find('[', pos);
+    const std::size_t end = json.find(']', pos);
+    if (pos == std::string::npos || end == std::string::npos) return false;
+
+    std::string list = json.substr(pos + 1, end - pos - 1);
+    for (char& c: list) if (c == ',') c = ' ';
+
+    values.clear();
+    std::istringstream in(list);
+    double value;
+    while (in >> value) values.push_back(value);
+    return true;
+  }
+
+  bool CheckPhysics(const std::string& observed, const std::string& golden,
+                    double sigma)
+  {
+    std::vector<double> obs, gold;
+    if (!GetArray(observed, "sensor_counts", obs) ||
+        !GetArray(golden, "sensor_counts", gold)) {
+      std::fprintf(stderr, "PHYSICS REGRESSION: sensor_counts missing.\n");
+      return false;
+    }
+
+    if (obs.size() != gold.size()) {
+      std::fprintf(stderr, "PHYSICS REGRESSION: %zu sensors, expected %zu.\n",
+                   obs.size(), gold.size());
+      return false;
+    }
+
+    double total_obs = 0., total_gold = 0.;
+    int num_failed = 0;
+
+    for (std::size_t i=0; i<obs.size(); ++i) {
+      total_obs  += obs[i];
+      total_gold += gold[i];
+      const double tolerance = sigma * std::sqrt(obs[i] + gold[i] + 1.);
+      if (std::fabs(obs[i] - gold[i]) > tolerance) {
+        std::fprintf(stderr, "PHYSICS REGRESSION: sensor %zu detected %.0f photons, "
+                     "expected %.0f +- %.1f\n", i, obs[i], gold[i], tolerance);
+        ++num_failed;
+      }
+    }
+
+    const double tolerance = sigma * std::sqrt(total_obs + total_gold + 1.);
+    if (std::fabs(total_obs - total_gold) > tolerance) {
+      std::fprintf(stderr, "PHYSICS REGRESSION: %.0f photons detected in total, "
+                   "expected %.0f +- %.1f\n", total_obs, total_gold, tolerance);
+      ++num_failed;
+    }
+
+    std::printf("physics: %zu sensors, %.0f photons detected (golden %.0f), "
+                "%d deviations beyond %.1f sigma\n",
+                obs.size(), total_obs, total_gold, num_failed, sigma);
+    return num_failed == 0;
+  }
+
+  bool CheckPerformance(const std::string& observed, const std::string& golden,
+                        double threshold)
+  {
+    double obs, gold;
+    if (!GetNumber(observed, "events_per_second", obs) ||
+        !GetNumber(golden, "events_per_second", gold)) {
+      std::fprintf(stderr, "PERFORMANCE REGRESSION: events_per_second missing.\n");
+      return false;
+    }
+
+    const double change = (gold > 0.) ? obs / gold - 1. : 0.;
+    std::printf("performance: %.3g events/s (golden %.3g, %+.1f%%, threshold -%.1f%%)\n",
+                obs, gold, 100. * change, 100. * threshold);
+
+    if (change < -threshold) {
+      std::fprintf(stderr, "PERFORMANCE REGRESSION: throughput dropped by %.1f%% "
+                   "(more than %.1f%%).\n", -100. * change, 100. * threshold);
+      return false;
+    }
+    return true;
+  }
+
+  bool CheckIdentical(const std::string& observed, const std::string& reference)
+  {
+    int num_failed = 0;
+
+    for (const char* key: {"events", "photons", "steps_per_photon"}) {
+      double obs, ref;
+      if (!GetNumber(observed, key, obs) || !GetNumber(reference, key, ref)) {
+        std::fprintf(stderr, "NOT REPRODUCIBLE: %s missing.\n", key);
+        return false;
+      }
+      if (obs != ref) {
+        std::fprintf(stderr, "NOT REPRODUCIBLE: %s is %.10g, expected %.10g\n",
+                     key, obs, ref);
+        ++num_failed;
+      }
+    }
+
+    std::vector<double> obs, ref;
+    if (!GetArray(observed, "sensor_counts", obs) ||
+        !GetArray(reference, "sensor_counts", ref)) {
+      std::fprintf(stderr, "NOT REPRODUCIBLE: sensor_counts missing.\n");
+      return false;
+    }
+
+    if (obs.size() != ref.size()) {
+      std::fprintf(stderr, "NOT REPRODUCIBLE: %zu sensors, expected %zu.\n",
+                   obs.size(), ref.size());
+      return false;
+    }
+
+    for (std::size_t i=0; i<obs.size(); ++i) {
+      if (obs[i] != ref[i]) {
+        std::fprintf(stderr, "NOT REPRODUCIBLE: sensor %zu detected %.0f photons, "
+                     "expected %.0f\n", i, obs[i], ref[i]);
+        ++num_failed;
+      }
+    }
+
+    std::printf("identical: %zu sensors, %d differences\n", obs.size(), num_failed);
+    return num_failed == 0;
+  }
+
+  void PrintUsage(const char* program)
+  {
+    std::fprintf(stderr,
+      "Usage: %s [options] <observed.json> <golden.json>\n"
+      "  --check <what>      physics, performance, all (default) or identical\n"
+      "  --sigma <n>         tolerance of the photon counts (default: 5)\n"
+      "  --threshold <f>     maximum relative drop of events/s (default: 0.2)\n"
+      "  --allow-missing     skip (exit code 77) instead of failing if there\n"
+      "                      is no golden summary\n"
+      "  --update            copy the observed summary to the golden one\n",
+      program);
+  }
+
+} // end namespace
+
+
+int main(int argc, char const *argv[])
+{
+  std::string check = "all";
+  double sigma = 5.;
+  double threshold = 0.2;
+  bool update = false;
+  bool allow_missing = false;
+  std::vector<std::string> files;
+
+  for (int i=1; i<argc; ++i) {
+    if (!std::strcmp(argv[i], "--check") && i+1 < argc)          check = argv[++i];
+    else if (!std::strcmp(argv[i], "--sigma") && i+1 < argc)     sigma = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--threshold") && i+1 < argc) threshold = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--update"))                  update = true;
+    else if (!std::strcmp(argv[i], "--allow-missing"))           allow_missing = true;
+    else files.push_back(argv[i]);
+  }
+
+  if (files.size() != 2 ||
+      (check != "all" && check != "physics" && check != "performance" &&
+       check != "identical")) {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::string observed, golden;
+  if (!ReadFile(files[0], observed)) {
+    std::fprintf(stderr, "ERROR: cannot read %s (did the run fail?)\n", files[0].c_str());
+    return EXIT_FAILURE;
+  }
+
+  if (update) {
+    std::ofstream out(files[1]);
+    out << observed;
+    if (!out) {
+      std::fprintf(stderr, "ERROR: cannot write %s\n", files[1].c_str());
+      return EXIT_FAILURE;
+    }
+    std::printf("Golden summary %s updated.\n", files[1].c_str());
+    return EXIT_SUCCESS;
+  }
+
+  if (check == "identical") {
+    if (!ReadFile(files[1], golden)) {
+      std::fprintf(stderr, "ERROR: cannot read %s (did the run fail?)\n", files[1].c_str());
+      return EXIT_FAILURE;
+    }
+    return CheckIdentical(observed, golden) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if (!ReadFile(files[1], golden)) {
+    if (allow_missing) {
+      std::printf("No golden summary %s: test skipped.\n", files[1].c_str());
+      return kSkipped;
+    }
+    std::fprintf(stderr, "MISSING GOLDEN: no summary %s; record it on the reference "
+                 "machine with 'make update_golden'.\n", files[1].c_str());
+    return EXIT_FAILURE;
+  }
+
+  bool ok = true;
+  if (check != "performance") ok = CheckPhysics(observed, golden, sigma) && ok;
+  if (check != "physics")     ok = CheckPerformance(observed, golden, threshold) && ok;
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,108 @@
+// -----------------------------------------------------------------------------
+//  G4OpSim | tools/G4OpSimClient.cpp
+//
+//  Minimal client of the simulation server (see SimulationServer.h), for
+//  testing: sends the request lines of a file (or of standard input) to
+//  the server socket, one at a time, and prints every reply as soon as it
+//  arrives. Returns 1 if any request failed.
+// -----------------------------------------------------------------------------
+
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+
+namespace {
+
+  bool ReadReply(int fd, std::string& buffer, std::string& reply)
+  {
+    size_t end;
+    while ((end = buffer.find('\n')) == std::string::npos) {
+      char chunk[4096];
+      const ssize_t n = read(fd, chunk, sizeof(chunk));
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      buffer.append(chunk, n);
+    }
+    reply = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return true;
+  }
+
+  bool SendRequest(int fd, const std::string& line)
+  {
+    const std::string data = line + '\n';
+    size_t sent = 0;
+    while (sent < data.size()) {
+      const ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      sent += n;
+    }
+    return true;
+  }
+
+} // namespace
+
+
+int main(int argc, char const *argv[])
+{
+  if (argc < 2) {
+    std::fprintf(stderr, "Usage: %s <socket> [requests file]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream file;
+  if (argc > 2) {
+    file.open(argv[2]);
+    if (!file) {
+      std::fprintf(stderr, "Cannot open %s\n", argv[2]);
+      return EXIT_FAILURE;
+    }
+  }
+  std::istream& requests = (argc > 2) ? file : std::cin;
+
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, argv[1], sizeof(address.sun_path) - 1);
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 ||
+      connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    std::fprintf(stderr, "Cannot connect to %s: %s\n", argv[1], std::strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  int status = EXIT_SUCCESS;
+  std::string line, buffer, reply;
+
+  while (std::getline(requests, line)) {
+    // The server does not reply to blank lines and comments
+    const size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') continue;
+
+    if (!SendRequest(fd, line) || !ReadReply(fd, buffer, reply)) {
+      std::fprintf(stderr, "Connection to the server lost\n");
+      status = EXIT_FAILURE;
+      break;
+    }
+
+    std::printf("%s\n", reply.c_str());
+    std::fflush(stdout);
+
+    if (reply.compare(0, 5, "error") == 0) status = EXIT_FAILURE;
+    if (reply == "bye") break;
+  }
+
+  close(fd);
+  return status;
+}